@@ -0,0 +1,80 @@
+#include "types.h"
+#include "def.h"
+#include "riscv.h"
+#include "sbi.h"
+#include "syscall.h"
+#include "process.h"
+
+/**
+ * 进程 CPU 时间与性能计数器统计
+ *
+ * 在 Trap 进出和进程切换时，把上次统计以来的时间计入当前进程的
+ * 用户态或内核态时间，同时累计时钟周期数和指令数
+ */
+
+extern struct ProcessControlBlock *current;
+
+// 上一次统计时的时钟、周期和指令计数
+static usize last_time, last_cycle, last_instret;
+
+/**
+ * 通过 SBI PMU 扩展启动 cycle 和 instret 计数器
+ *
+ * 不支持 PMU 扩展时假定 M 态已经让计数器运行并允许 S 态读取
+ */
+void init_acct() {
+    int has_pmu = sbi_probe_extension(SBI_EXT_PMU);
+    if (has_pmu) {
+        usize flags = SBI_PMU_CFG_FLAG_CLEAR_VALUE | SBI_PMU_CFG_FLAG_AUTO_START;
+        // cycle 为 0 号计数器，instret 为 2 号计数器
+        sbi_call(SBI_EXT_PMU, SBI_PMU_COUNTER_CONFIG_MATCHING, 0, 1 << 0, flags,
+                 SBI_PMU_HW_CPU_CYCLES, 0);
+        sbi_call(SBI_EXT_PMU, SBI_PMU_COUNTER_CONFIG_MATCHING, 2, 1 << 0, flags,
+                 SBI_PMU_HW_INSTRUCTIONS, 0);
+    }
+    last_time = r_time();
+    last_cycle = r_cycle();
+    last_instret = r_instret();
+    printf("***** Init Accounting (%s) *****\n", has_pmu ? "SBI PMU" : "CSR");
+}
+
+/**
+ * 将上次统计以来的 CPU 资源计入当前进程
+ *
+ * @param user 这段时间是否运行在用户态
+ */
+void account_cpu(int user) {
+    usize now = r_time();
+    usize cycle = r_cycle();
+    usize instret = r_instret();
+    if (user) {
+        current->utime += now - last_time;
+    } else {
+        current->stime += now - last_time;
+    }
+    current->cycles += cycle - last_cycle;
+    current->instret += instret - last_instret;
+    last_time = now;
+    last_cycle = cycle;
+    last_instret = instret;
+}
+
+/**
+ * 填写进程使用的 CPU 资源
+ */
+void get_times(struct ProcessControlBlock *process, struct ProcTimes *times) {
+    times->utime = ticks_to_ns(process->utime);
+    times->stime = ticks_to_ns(process->stime);
+    times->cycles = process->cycles;
+    times->instret = process->instret;
+}
+
+/**
+ * 获取当前线程使用的 CPU 资源
+ */
+int sys_times(struct ProcTimes *times) {
+    // 先计入本次系统调用已经使用的时间
+    account_cpu(0);
+    get_times(current, times);
+    return 0;
+}
@@ -0,0 +1,80 @@
+#ifndef _BITOPS_H
+#define _BITOPS_H
+
+#include "types.h"
+
+/**
+ * 找到最低位的 1 的下标
+ *
+ * @param x 不能为 0
+ */
+static inline int lowest_bit(usize x) {
+    int bit = 0;
+    if (!(x & 0xffffffff)) {
+        x >>= 32;
+        bit += 32;
+    }
+    if (!(x & 0xffff)) {
+        x >>= 16;
+        bit += 16;
+    }
+    if (!(x & 0xff)) {
+        x >>= 8;
+        bit += 8;
+    }
+    if (!(x & 0xf)) {
+        x >>= 4;
+        bit += 4;
+    }
+    if (!(x & 0x3)) {
+        x >>= 2;
+        bit += 2;
+    }
+    if (!(x & 0x1)) {
+        bit += 1;
+    }
+    return bit;
+}
+
+/**
+ * 找到最高位的 1 的下标，即 log2(x) 向下取整
+ *
+ * @param x 不能为 0
+ */
+static inline int highest_bit(usize x) {
+    int bit = 0;
+    if (x >> 32) {
+        x >>= 32;
+        bit += 32;
+    }
+    if (x >> 16) {
+        x >>= 16;
+        bit += 16;
+    }
+    if (x >> 8) {
+        x >>= 8;
+        bit += 8;
+    }
+    if (x >> 4) {
+        x >>= 4;
+        bit += 4;
+    }
+    if (x >> 2) {
+        x >>= 2;
+        bit += 2;
+    }
+    if (x >> 1) {
+        bit += 1;
+    }
+    return bit;
+}
+
+/**
+ * 循环右移
+ */
+static inline usize rotate_right(usize x, int shift) {
+    shift &= 63;
+    return shift ? (x >> shift) | (x << (64 - shift)) : x;
+}
+
+#endif
@@ -0,0 +1,227 @@
+#include "types.h"
+#include "def.h"
+#include "consts.h"
+#include "riscv.h"
+#include "timer.h"
+#include "process.h"
+#include "mapping.h"
+#include "sbi.h"
+
+#define CONSOLE_BUF_SIZE 128
+// 有进程等待输入时轮询 SBI 的频率
+#define POLLS_PER_SEC 100
+
+extern struct ProcessControlBlock *current;
+
+// 16550 寄存器
+#define UART_RBR 0
+#define UART_THR 0
+#define UART_IER 1
+#define UART_LSR 5
+#define IER_RX_ENABLE (1 << 0)
+#define LSR_DR (1 << 0)
+#define LSR_THRE (1 << 5)
+
+/**
+ * 控制台输出方式，默认逐字符调用 SBI
+ */
+enum ConsoleOut {
+    OutLegacy,
+    // SBI Debug Console 扩展，一次调用输出一段数据
+    OutDbcn,
+    // 直接写串口寄存器，不陷入 M 态
+    OutUart,
+};
+
+static enum ConsoleOut console_out = OutLegacy;
+// DBCN 需要物理地址，先将数据复制到内核缓冲区
+static char out_buf[CONSOLE_OUT_SIZE];
+
+/**
+ * 控制台输入缓冲区
+ */
+static struct {
+    char buf[CONSOLE_BUF_SIZE];
+    // 读写位置，只增不减，取模得到下标
+    uint r;
+    uint w;
+    // 等待输入的进程
+    struct WaitQueue wait;
+    // 轮询定时器，只在有进程等待输入时添加
+    struct Timer poll_timer;
+    // 输入由串口中断送入缓冲区，不再轮询
+    int irq;
+} cons;
+
+/**
+ * 是否有进程在等待控制台输入
+ */
+static int console_has_waiters() { return !list_empty(&cons.wait.head); }
+
+static void poll_timeout(struct Timer *timer) {
+    console_poll_input();
+    if (console_has_waiters()) {
+        add_timer(timer, r_time() + CLOCK_FREQ / POLLS_PER_SEC);
+    }
+}
+
+void init_console() {
+    cons.r = cons.w = 0;
+    cons.irq = 0;
+    init_wait_queue(&cons.wait);
+    setup_timer(&cons.poll_timer, poll_timeout);
+    if (sbi_probe_extension(SBI_EXT_DBCN)) {
+        console_out = OutDbcn;
+    } else {
+#ifdef QEMU
+        console_out = OutUart;
+#endif
+    }
+    char *out_name[] = {"SBI legacy", "SBI DBCN", "UART"};
+    printf("***** Init Console (%s) *****\n", out_name[console_out]);
+}
+
+#ifdef QEMU
+static void uart_write(char *buf, int count) {
+    volatile uint8 *uart = (volatile uint8 *)__va(UART0);
+    for (int i = 0; i < count; ++i) {
+        while (!(uart[UART_LSR] & LSR_THRE)) {
+        }
+        uart[UART_THR] = buf[i];
+    }
+}
+
+/**
+ * 打开串口接收中断，之后输入由 console_intr() 送入缓冲区
+ */
+void console_enable_irq() {
+    volatile uint8 *uart = (volatile uint8 *)__va(UART0);
+    uart[UART_IER] = IER_RX_ENABLE;
+    cons.irq = 1;
+    del_timer(&cons.poll_timer);
+}
+
+/**
+ * 串口接收中断，取出所有到达的字符并唤醒等待输入的进程
+ *
+ * 缓冲区满时丢弃新到的字符
+ */
+void console_intr() {
+    volatile uint8 *uart = (volatile uint8 *)__va(UART0);
+    int got = 0;
+    while (uart[UART_LSR] & LSR_DR) {
+        char c = uart[UART_RBR];
+        if (cons.w - cons.r < CONSOLE_BUF_SIZE) {
+            cons.buf[cons.w++ % CONSOLE_BUF_SIZE] = c;
+            got = 1;
+        }
+    }
+    if (got) {
+        wakeup(&cons.wait);
+    }
+}
+#endif
+
+/**
+ * 输出一段数据
+ *
+ * 优先整段交给 SBI DBCN，其次在 QEMU 上直接写串口，最后逐字符调用 SBI
+ */
+void console_write(char *buf, int count) {
+    switch (console_out) {
+    case OutDbcn:
+        while (count > 0) {
+            int len = count < CONSOLE_OUT_SIZE ? count : CONSOLE_OUT_SIZE;
+            for (int i = 0; i < len; ++i) {
+                out_buf[i] = buf[i];
+            }
+            for (int off = 0; off < len;) {
+                long num = sbi_console_write(__pa((usize)out_buf) + off,
+                                             len - off);
+                if (num < 0) {
+                    return;
+                }
+                off += num;
+            }
+            buf += len;
+            count -= len;
+        }
+        break;
+#ifdef QEMU
+    case OutUart:
+        uart_write(buf, count);
+        break;
+#endif
+    default:
+        for (int i = 0; i < count; ++i) {
+            console_putchar(buf[i]);
+        }
+        break;
+    }
+}
+
+/**
+ * 从 SBI 取出已到达的字符放入输入缓冲区，并唤醒等待输入的进程
+ *
+ * 只有在有进程等待输入时才进行轮询，避免无谓的 SBI 调用
+ */
+void console_poll_input() {
+    if (!console_has_waiters()) {
+        return;
+    }
+    int got = 0;
+    while (cons.w - cons.r < CONSOLE_BUF_SIZE) {
+        char c = console_getchar();
+        if (c == (char)-1) {
+            break;
+        }
+        cons.buf[cons.w++ % CONSOLE_BUF_SIZE] = c;
+        got = 1;
+    }
+    if (got) {
+        wakeup(&cons.wait);
+    }
+}
+
+/**
+ * 没有输入中断时，开始轮询 SBI
+ */
+static void start_polling() {
+    if (!cons.irq && !timer_pending(&cons.poll_timer)) {
+        add_timer(&cons.poll_timer, r_time() + CLOCK_FREQ / POLLS_PER_SEC);
+    }
+}
+
+/**
+ * 查询控制台是否有输入，登记等待时开始轮询
+ */
+short console_poll(struct PollTable *pt) {
+    if (cons.r != cons.w) {
+        return POLLIN;
+    }
+    if (pt) {
+        poll_wait(pt, &cons.wait);
+        start_polling();
+    }
+    return 0;
+}
+
+/**
+ * 从控制台读取至多 `count` 字节，没有输入时阻塞
+ *
+ * @return 读取的字节数
+ */
+int console_read(char *buf, int count) {
+    while (cons.r == cons.w) {
+        if (current->killed) {
+            return -1;
+        }
+        start_polling();
+        sleep_on(&cons.wait);
+    }
+    int num = 0;
+    while (num < count && cons.r != cons.w) {
+        buf[num++] = cons.buf[cons.r++ % CONSOLE_BUF_SIZE];
+    }
+    return num;
+}
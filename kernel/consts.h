@@ -14,7 +14,16 @@ extern void ebss();
 extern void ekernel();
 
 #define PAGE_SIZE 4096
+// 硬件时钟频率
+#define CLOCK_FREQ 10000000
 #define MEMORY_END 0x88000000
+// QEMU virt 的 NS16550 串口及其中断号
+#define UART0 0x10000000
+#define UART0_IRQ 10
+// QEMU virt 的 PLIC
+#define PLIC 0x0c000000
+// 控制台一次输出的最大字节数
+#define CONSOLE_OUT_SIZE 256
 
 // 内核地址线性映射偏移
 #define KERNEL_MAP_OFFSET 0xffffffff00000000
@@ -27,5 +36,9 @@ extern void ekernel();
 #define USER_STACK_SIZE (PAGE_SIZE * 4)
 // 用户栈起始地址
 #define USER_STACK 0xffffffff00000000
+// 每个地址空间最多的用户栈（线程）数，线程栈从 USER_STACK 向下排列，
+// 相邻的栈之间留出一页不映射的保护页
+#define MAX_STACK_SLOTS 64
+#define STACK_SLOT_VA(slot) (USER_STACK - (slot) * (USER_STACK_SIZE + PAGE_SIZE))
 
 #endif
\ No newline at end of file
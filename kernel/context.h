@@ -23,7 +23,16 @@ struct ProcessContext {
     usize ra;
     usize sp;
     usize s[12];
+    // 进程页表，0 表示沿用当前页表
     usize satp;
 };
 
+/**
+ * 浮点上下文
+ */
+struct FpuContext {
+    usize f[32];
+    usize fcsr;
+};
+
 #endif
\ No newline at end of file
@@ -11,14 +11,47 @@ struct ProcessContext;
 struct ProcessControlBlock;
 struct Inode;
 struct File;
+struct Pipe;
+struct PollTable;
+struct PollFd;
+struct SyscallStats;
+struct TraceRecord;
+struct WaitQueue;
+struct Timer;
+struct SpawnAction;
+struct Work;
+struct FpuContext;
+struct ProcTimes;
+struct ProcInfo;
+struct SbiRet;
+struct RingCtx;
+struct Shm;
 enum SegmentType;
 
+/* acct.c */
+void init_acct();
+void account_cpu(int);
+void get_times(struct ProcessControlBlock *, struct ProcTimes *);
+int sys_times(struct ProcTimes *);
+
 /* buddy_system_allocator.c */
 void init_buddy(struct Buddy *);
 void add_to_buddy(struct Buddy *, void *, void *);
 void *buddy_alloc(struct Buddy *, uint64);
 void buddy_dealloc(struct Buddy *, void *, uint64);
 
+/* console.c */
+void init_console();
+void console_poll_input();
+void console_enable_irq();
+void console_intr();
+int console_read(char *, int);
+short console_poll(struct PollTable *);
+void console_write(char *, int);
+
+/* dtb.c */
+int dtb_has_isa_extension(usize, char *);
+
 /* elf.c */
 struct MemoryMap *from_elf(char *);
 
@@ -26,45 +59,123 @@ struct MemoryMap *from_elf(char *);
 void init_fs();
 struct Inode *lookup(char *);
 int readall(struct Inode *, char *);
-void dealloc_files(struct File **);
+struct FileTable *new_file_table();
+void close_file(struct File *);
+struct File *get_file(int);
+int alloc_fd(struct FileTable *, struct File *);
+int install_fd(struct FileTable *, int, struct File *);
+void close_fd(struct FileTable *, int);
+struct FileTable *copy_file_table(struct FileTable *);
+void put_file_table(struct FileTable *);
 int sys_open(char *, int);
 int sys_close(int);
 int sys_read(int, char *, int);
 int sys_write(int, char *, int);
+int sys_dup(int);
+int sys_dup2(int, int);
+short file_poll(struct File *, struct PollTable *);
+
+/* fpu.c */
+int fpu_trap(struct TrapContext *);
+void fpu_flush();
+void fpu_release(struct ProcessControlBlock *);
+
+/* fpuswitch.S */
+void __fpu_save(struct FpuContext *);
+void __fpu_restore(struct FpuContext *);
+
+/* futex.c */
+void init_futex();
+int sys_futex(usize, int, usize);
 
 /* kerneltrap.S */
 void __trap_entry();
 void __restore(struct TrapContext *current_trap_cx);
 
+/* kthread.c */
+void schedule_work(struct Work *);
+void cond_resched();
+void init_kthreads();
+
+/* ipc.c */
+int sys_ipc_call(int);
+int sys_ipc_reply_wait(int);
+void ipc_exit(struct ProcessControlBlock *);
+
 /* memory.c */
 void init_memory();
 void *alloc(usize);
 void dealloc(void *, usize);
 usize alloc_frame();
+void kzerod(void *);
 void dealloc_frame(usize);
 
 /* mapping.c */
 struct Segment *new_segment(usize, usize, usize, enum SegmentType);
 void map_segment(usize, struct Segment *, char *, usize);
 void map_pages(usize, usize, usize, int, usize);
+void unmap_pages(usize, usize, int);
+usize translate(struct MemoryMap *, usize);
 struct MemoryMap *new_kernel_memory_map();
 struct MemoryMap *remap_kernel();
 void dealloc_memory_map(struct MemoryMap *);
+struct MemoryMap *mm_get(struct MemoryMap *);
+void mm_put(struct MemoryMap *);
 struct MemoryMap *copy_mm(struct MemoryMap *);
 void activate_pagetable(usize);
 
+/* pipe.c */
+int sys_pipe(int *);
+int pipe_read(struct Pipe *, char *, int);
+int pipe_write(struct Pipe *, char *, int);
+short pipe_poll(struct Pipe *, int, struct PollTable *);
+void pipe_close(struct Pipe *, int);
+
+/* plic.c */
+void init_plic();
+void plic_handle();
+
+/* poll.c */
+void poll_wait(struct PollTable *, struct WaitQueue *);
+int sys_poll(struct PollFd *, int, usize);
+
 /* printf.c */
 void printf(char *, ...);
 void panic(char *, ...) __attribute__((noreturn));
 
+/* ring.c */
+struct RingCtx *ring_dup(struct RingCtx *);
+void ring_free(struct RingCtx *);
+usize sys_ring_setup(int);
+int sys_ring_enter(int);
+void ring_poll();
+
 /* sbi.c */
 void console_putchar(usize);
 usize console_getchar();
 void shutdown() __attribute__((noreturn));
 void set_timer(usize);
+struct SbiRet sbi_call(usize, usize, usize, usize, usize, usize, usize);
+int sbi_probe_extension(usize);
+long sbi_console_write(usize, usize);
+
+/* shm.c */
+void init_shm();
+struct Shm *shm_get(struct Shm *);
+void shm_put(struct Shm *);
+int sys_shm_create(char *, usize);
+int sys_shm_unlink(char *);
+usize sys_shm_attach(char *);
+int sys_shm_detach(usize);
+
+/* sysstat.c */
+void sysstat_record(usize, usize, usize, usize, usize, usize);
+void sysstat_free(struct ProcessControlBlock *);
+int sys_sysstat(int, int, struct SyscallStats *);
+int sys_trace_read(struct TraceRecord *, int);
 
 /* syscall.c */
-usize syscall(usize, usize[3]);
+usize syscall(usize, usize, usize, usize);
 
 /* switch.S */
 void __switch(struct ProcessContext *current_process_cx,
@@ -79,11 +190,49 @@ void init_process();
 void exit_current();
 int sys_fork();
 int sys_wait();
+int sys_waitpid(int);
+int sys_kill(int);
+struct ProcessControlBlock *find_process(int);
 int sys_exec(char *);
+int sys_spawn(char *, char **, struct SpawnAction *);
+int sys_clone(usize, usize, usize);
+int sys_join(int);
+struct ProcessControlBlock *kthread_create(void (*)(void *), void *, int,
+                                           char *);
+int sys_proc_list(struct ProcInfo *, int);
+int runnable();
+void preempt_disable();
+void preempt_enable();
 void yield();
+void init_wait_queue(struct WaitQueue *);
+void wake_process(struct ProcessControlBlock *);
+void handoff(struct ProcessControlBlock *);
+void block_current();
+void sleep_on(struct WaitQueue *);
+void wakeup(struct WaitQueue *);
 
 /* timer.c */
+void probe_timer(usize);
+void set_deadline(usize);
 void init_timer();
-void set_next_timeout();
+void test_timer();
+void setup_timer(struct Timer *, void (*)(struct Timer *));
+void add_timer(struct Timer *, usize);
+void del_timer(struct Timer *);
+void program_timer();
+void start_slice();
+void timer_tick();
+usize ns_to_ticks(usize);
+usize ticks_to_ns(usize);
+void sleep_until_ticks(usize);
+int sys_nanosleep(usize);
+int sys_sleep_until(usize);
+usize sys_gettime();
+
+/* vdso.c */
+void init_vdso();
+void map_vdso(struct MemoryMap *);
+void vdso_set_pid(struct MemoryMap *, int);
+void vdso_update_ticks(usize);
 
 #endif
\ No newline at end of file
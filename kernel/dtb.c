@@ -0,0 +1,112 @@
+#include "types.h"
+#include "def.h"
+#include "consts.h"
+#include "mapping.h"
+
+// 设备树魔数
+#define FDT_MAGIC 0xd00dfeed
+// 设备树结构块的标记
+#define FDT_BEGIN_NODE 1
+#define FDT_END_NODE 2
+#define FDT_PROP 3
+#define FDT_NOP 4
+#define FDT_END 9
+
+/**
+ * 设备树头部，所有字段均为大端序
+ */
+struct FdtHeader {
+    uint32 magic;
+    uint32 totalsize;
+    uint32 off_dt_struct;
+    uint32 off_dt_strings;
+    uint32 off_mem_rsvmap;
+    uint32 version;
+    uint32 last_comp_version;
+    uint32 boot_cpuid_phys;
+    uint32 size_dt_strings;
+    uint32 size_dt_struct;
+};
+
+static inline uint32 be32(uint32 x) {
+    return ((x & 0xff) << 24) | ((x & 0xff00) << 8) | ((x >> 8) & 0xff00) |
+           (x >> 24);
+}
+
+/**
+ * 在长度为 `len` 的数据中查找字符串 `str`
+ */
+static int contains(char *data, int len, char *str) {
+    for (int i = 0; i < len; ++i) {
+        int j = 0;
+        while (str[j] && i + j < len && data[i + j] == str[j]) {
+            ++j;
+        }
+        if (!str[j]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int streq(char *a, char *b) {
+    while (*a && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+/**
+ * 检查设备树中 CPU 的 ISA 描述是否包含某个扩展
+ *
+ * 同时检查 riscv,isa 字符串和 riscv,isa-extensions 列表。
+ * 需在内存分配器覆盖设备树之前调用。
+ *
+ * @param dtb 设备树的物理地址，由 SBI 在启动时通过 a1 传入
+ * @param ext 小写的扩展名，例如 "sstc"
+ */
+int dtb_has_isa_extension(usize dtb, char *ext) {
+    // 启动页表只映射了内核所在的 1G 空间
+    if (dtb < 0x80000000 || dtb >= MEMORY_END) {
+        return 0;
+    }
+    struct FdtHeader *header = (struct FdtHeader *)__va(dtb);
+    if (be32(header->magic) != FDT_MAGIC) {
+        return 0;
+    }
+    uint32 *token = (uint32 *)((usize)header + be32(header->off_dt_struct));
+    char *strings = (char *)header + be32(header->off_dt_strings);
+    while (1) {
+        switch (be32(*token++)) {
+        case FDT_BEGIN_NODE: {
+            // 跳过节点名，4 字节对齐
+            char *name = (char *)token;
+            int len = 0;
+            while (name[len]) {
+                ++len;
+            }
+            token += (len + 4) / 4;
+            break;
+        }
+        case FDT_PROP: {
+            uint32 len = be32(token[0]);
+            char *name = strings + be32(token[1]);
+            char *value = (char *)(token + 2);
+            if ((streq(name, "riscv,isa") ||
+                 streq(name, "riscv,isa-extensions")) &&
+                contains(value, len, ext)) {
+                return 1;
+            }
+            token += 2 + (len + 3) / 4;
+            break;
+        }
+        case FDT_END_NODE:
+        case FDT_NOP:
+            break;
+        case FDT_END:
+        default:
+            return 0;
+        }
+    }
+}
@@ -53,5 +53,6 @@ struct MemoryMap *from_elf(char *elf) {
         map_segment(res->root_ppn, segment, data, p_header->p_memsz);
         list_add(&segment->list, &res->segment_list);
     }
+    map_vdso(res);
     return res;
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "types.h"
+#include "def.h"
+#include "riscv.h"
+#include "context.h"
+#include "process.h"
+
+/**
+ * 浮点寄存器的懒惰保存与恢复
+ *
+ * 进程开始时 sstatus.FS 为 Off，第一次使用浮点指令时触发非法指令异常，
+ * 此时才把 FPU 中上一个所有者的寄存器保存起来并恢复当前进程的寄存器。
+ * 只有 FPU 所有者的 sstatus.FS 不为 Off，进程切换时不需要处理浮点状态，
+ * 不使用浮点的进程没有额外开销。
+ */
+
+extern struct ProcessControlBlock *current;
+
+// 浮点寄存器中保存的是该进程的状态
+static struct ProcessControlBlock *fpu_owner = NULL;
+
+static inline void set_fs(usize *sstatus, usize fs) {
+    *sstatus = (*sstatus & ~SSTATUS_FS) | fs;
+}
+
+/**
+ * 所有者修改过浮点寄存器时将其保存到浮点上下文中
+ */
+static void save_owner() {
+    if ((fpu_owner->trap_cx.sstatus & SSTATUS_FS) == SSTATUS_FS_DIRTY) {
+        __fpu_save(&fpu_owner->fpu_cx);
+        set_fs(&fpu_owner->trap_cx.sstatus, SSTATUS_FS_CLEAN);
+    }
+}
+
+/**
+ * 处理用户态非法指令异常，若为第一次使用浮点指令则将 FPU 交给当前进程
+ *
+ * @return -1 不是浮点指令引起的异常
+ */
+int fpu_trap(struct TrapContext *context) {
+    if ((context->sstatus & SSTATUS_FS) != SSTATUS_FS_OFF) {
+        return -1;
+    }
+    // 内核访问浮点寄存器前需要打开 FPU
+    w_sstatus(r_sstatus() | SSTATUS_FS);
+    if (fpu_owner != current) {
+        if (fpu_owner) {
+            save_owner();
+            set_fs(&fpu_owner->trap_cx.sstatus, SSTATUS_FS_OFF);
+        }
+        __fpu_restore(&current->fpu_cx);
+        fpu_owner = current;
+    }
+    set_fs(&context->sstatus, SSTATUS_FS_CLEAN);
+    return 0;
+}
+
+/**
+ * 将当前进程在 FPU 中的状态写回浮点上下文，用于 fork 复制
+ */
+void fpu_flush() {
+    if (fpu_owner == current) {
+        w_sstatus(r_sstatus() | SSTATUS_FS);
+        save_owner();
+    }
+}
+
+/**
+ * 丢弃进程的浮点状态，用于进程退出和 exec
+ */
+void fpu_release(struct ProcessControlBlock *process) {
+    if (fpu_owner == process) {
+        fpu_owner = NULL;
+    }
+    for (int i = 0; i < 32; ++i) {
+        process->fpu_cx.f[i] = 0;
+    }
+    process->fpu_cx.fcsr = 0;
+    set_fs(&process->trap_cx.sstatus, SSTATUS_FS_OFF);
+}
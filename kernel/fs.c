@@ -1,8 +1,10 @@
 #include "types.h"
 #include "def.h"
+#include "consts.h"
 #include "fs.h"
 #include "string.h"
 #include "process.h"
+#include "bitops.h"
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
@@ -102,9 +104,11 @@ int read_from_inode(struct Inode *inode, int off, char *buf, int count) {
                            : (char *)get_block(indirect[i - 12]);
         src += block_off;
         int len = MIN(max_size - num, BLOCK_SIZE - block_off);
+        preempt_enable();
         for (int j = 0; j < len; ++j) {
             buf[j] = src[j];
         }
+        preempt_disable();
         buf += len;
         num += len;
         block_off = 0;
@@ -135,40 +139,51 @@ struct Inode *create(char *name) {
 }
 
 int sys_open(char *name, int flags) {
-    for (int i = 0; i < NR_OPEN; ++i) {
-        if (!(current->files[i])) {
-            struct Inode *inode;
-            if (!strcmp("/\0", name)) {
-                // 根目录使用虚拟 inode 节点
-                inode = &ROOT_INODE;
+    // 先占用文件描述符，表满时不创建文件
+    int fd = alloc_fd(current->files, NULL);
+    if (fd == -1) {
+        return -1;
+    }
+    struct Inode *inode;
+    if (!strcmp("/\0", name)) {
+        // 根目录使用虚拟 inode 节点
+        inode = &ROOT_INODE;
+    } else {
+        inode = lookup(name);
+        if (!inode) {
+            if ((flags & O_CREATE)) {
+                inode = create(name);
             } else {
-                inode = lookup(name);
-                if (!inode) {
-                    if ((flags & O_CREATE)) {
-                        inode = create(name);
-                    } else {
-                        return -1;
-                    }
-                }
+                close_fd(current->files, fd);
+                return -1;
             }
-            struct File *file = (struct File *)alloc(sizeof(struct File));
-            file->count = 1;
-            file->off = 0;
-            file->inode = inode;
-            current->files[i] = file;
-            return i;
         }
     }
-    return -1;
+    struct File *file = (struct File *)alloc(sizeof(struct File));
+    file->type = FILE_INODE;
+    file->count = 1;
+    file->off = 0;
+    file->inode = inode;
+    file->pipe = NULL;
+    current->files->fdt->fd[fd] = file;
+    return fd;
 }
 
-int sys_close(int fd) {
-    if (fd >= 0 && fd < NR_OPEN && current->files[fd]) {
-        struct File *file = current->files[fd];
-        if (!--(file->count)) {
-            dealloc((void *)file, sizeof(struct File));
+/**
+ * 释放打开文件的一个引用，最后一个引用释放时关闭文件
+ */
+void close_file(struct File *file) {
+    if (file && !--(file->count)) {
+        if (file->type == FILE_PIPE) {
+            pipe_close(file->pipe, file->writable);
         }
-        current->files[fd] = NULL;
+        dealloc((void *)file, sizeof(struct File));
+    }
+}
+
+int sys_close(int fd) {
+    if (get_file(fd)) {
+        close_fd(current->files, fd);
     }
     return 0;
 }
@@ -177,8 +192,8 @@ int sys_read(int fd, char *buf, int count) {
     if (!count) {
         return 0;
     }
-    if (fd >= 0 && fd < NR_OPEN && current->files[fd]) {
-        struct File *file = current->files[fd];
+    struct File *file = get_file(fd);
+    if (file) {
         // 读取根目录
         if (file->inode == &ROOT_INODE) {
             int num = sizeof(struct Inode);
@@ -201,17 +216,13 @@ int sys_read(int fd, char *buf, int count) {
             return 0;
         }
 
-        // 标准输入
+        // 标准输入，没有输入时阻塞
         if (file->type == FILE_STDIO) {
-            while (1) {
-                char c = console_getchar();
-                if (c == (char)-1) {
-                    yield();
-                } else {
-                    buf[0] = c;
-                    return 1;
-                }
-            }
+            return console_read(buf, count);
+        }
+
+        if (file->type == FILE_PIPE) {
+            return file->writable ? -1 : pipe_read(file->pipe, buf, count);
         }
 
         // 文件输入
@@ -256,17 +267,22 @@ void increase_size(struct Inode *inode, int new_size) {
 }
 
 int sys_write(int fd, char *buf, int count) {
-    if (fd >= 0 && fd < NR_OPEN && current->files[fd]) {
-        struct File *file = current->files[fd];
-
+    struct File *file = get_file(fd);
+    if (file) {
         if (file->type == FILE_STDIO) {
-            // 标准输出
-            for (int i = 0; i < count; ++i) {
-                console_putchar(buf[i]);
+            // 标准输出，整块输出，块之间允许被抢占
+            for (int num = 0; num < count; num += CONSOLE_OUT_SIZE) {
+                console_write(buf + num, MIN(count - num, CONSOLE_OUT_SIZE));
+                preempt_enable();
+                preempt_disable();
             }
             return count;
         }
 
+        if (file->type == FILE_PIPE) {
+            return file->writable ? pipe_write(file->pipe, buf, count) : -1;
+        }
+
         // 文件输出
         struct Inode *inode = file->inode;
         int new_size = file->off + count;
@@ -282,9 +298,11 @@ int sys_write(int fd, char *buf, int count) {
                                : (char *)get_block(indirect[i - 12]);
             dst += block_off;
             int len = MIN(count - num, BLOCK_SIZE - block_off);
+            preempt_enable();
             for (int j = 0; j < len; ++j) {
                 dst[j] = buf[j];
             }
+            preempt_disable();
             buf += len;
             num += len;
             block_off = 0;
@@ -299,13 +317,246 @@ int sys_write(int fd, char *buf, int count) {
     return -1;
 }
 
-void dealloc_files(struct File **files) {
-    for (int i = 0; i < NR_OPEN; ++i) {
-        if (files[i]) {
-            if (!--(files[i]->count)) {
-                dealloc((void *)files[i], sizeof(struct File));
+/**
+ * 复制文件描述符，使用最小的空闲文件描述符
+ *
+ * @return 新的文件描述符，-1 表示 `oldfd` 不合法或表已满
+ */
+int sys_dup(int oldfd) {
+    struct File *file = get_file(oldfd);
+    if (!file) {
+        return -1;
+    }
+    int fd = alloc_fd(current->files, file);
+    if (fd != -1) {
+        ++file->count;
+    }
+    return fd;
+}
+
+/**
+ * 使 `newfd` 指向 `oldfd` 的打开文件，`newfd` 原来打开的文件先被关闭
+ *
+ * @return newfd，-1 表示文件描述符不合法
+ */
+int sys_dup2(int oldfd, int newfd) {
+    struct File *file = get_file(oldfd);
+    if (!file || newfd < 0 || newfd >= NR_OPEN) {
+        return -1;
+    }
+    if (oldfd != newfd) {
+        ++file->count;
+        install_fd(current->files, newfd, file);
+    }
+    return newfd;
+}
+
+/**
+ * 查询文件的就绪状态，并在文件的等待队列上登记
+ *
+ * @param pt 为 NULL 时只查询
+ * @return 就绪的事件
+ */
+short file_poll(struct File *file, struct PollTable *pt) {
+    if (file->type == FILE_PIPE) {
+        return pipe_poll(file->pipe, file->writable, pt);
+    }
+    if (file->type == FILE_STDIO) {
+        return console_poll(pt) | POLLOUT;
+    }
+    // 普通文件总是就绪
+    return POLLIN | POLLOUT;
+}
+
+static struct FdArray *alloc_fdt(int max_fds) {
+    struct FdArray *fdt = (struct FdArray *)alloc(sizeof(struct FdArray));
+    fdt->count = 1;
+    fdt->max_fds = max_fds;
+    fdt->fd = (struct File **)alloc(max_fds * sizeof(struct File *));
+    fdt->open_fds = (usize *)alloc(max_fds / 64 * sizeof(usize));
+    for (int i = 0; i < max_fds; ++i) {
+        fdt->fd[i] = NULL;
+    }
+    for (int i = 0; i < max_fds / 64; ++i) {
+        fdt->open_fds[i] = 0;
+    }
+    return fdt;
+}
+
+static void free_fdt(struct FdArray *fdt) {
+    dealloc((void *)fdt->fd, fdt->max_fds * sizeof(struct File *));
+    dealloc((void *)fdt->open_fds, fdt->max_fds / 64 * sizeof(usize));
+    dealloc((void *)fdt, sizeof(struct FdArray));
+}
+
+/**
+ * 复制文件描述符数组到长度为 `max_fds` 的新数组
+ *
+ * @param share 为真时新数组另外持有各文件的引用，否则接管原数组的引用
+ */
+static struct FdArray *copy_fdt(struct FdArray *src, int max_fds, int share) {
+    struct FdArray *fdt = alloc_fdt(max_fds);
+    for (int w = 0; w < src->max_fds / 64; ++w) {
+        usize bits = src->open_fds[w];
+        fdt->open_fds[w] = bits;
+        // 只遍历已使用的文件描述符
+        while (bits) {
+            int fd = w * 64 + lowest_bit(bits);
+            bits &= bits - 1;
+            fdt->fd[fd] = src->fd[fd];
+            if (share && fdt->fd[fd]) {
+                ++fdt->fd[fd]->count;
             }
-            files[i] = NULL;
         }
     }
-}
\ No newline at end of file
+    return fdt;
+}
+
+/**
+ * 释放文件描述符数组的引用，最后一个引用释放时关闭所有文件
+ */
+static void put_fdt(struct FdArray *fdt) {
+    if (--fdt->count) {
+        return;
+    }
+    for (int w = 0; w < fdt->max_fds / 64; ++w) {
+        usize bits = fdt->open_fds[w];
+        while (bits) {
+            close_file(fdt->fd[w * 64 + lowest_bit(bits)]);
+            bits &= bits - 1;
+        }
+    }
+    free_fdt(fdt);
+}
+
+/**
+ * 准备修改打开文件表，数组被共享时先复制，长度不足 `min_fds` 时扩充
+ *
+ * @return 可以修改的数组
+ */
+static struct FdArray *fdt_for_write(struct FileTable *files, int min_fds) {
+    struct FdArray *fdt = files->fdt;
+    int max_fds = fdt->max_fds;
+    while (max_fds < min_fds) {
+        max_fds *= 2;
+    }
+    if (fdt->count == 1 && max_fds == fdt->max_fds) {
+        return fdt;
+    }
+    struct FdArray *new_fdt = copy_fdt(fdt, max_fds, fdt->count > 1);
+    if (fdt->count > 1) {
+        --fdt->count;
+    } else {
+        free_fdt(fdt);
+    }
+    files->fdt = new_fdt;
+    return new_fdt;
+}
+
+/**
+ * 获取当前进程的打开文件
+ *
+ * @return NULL 表示文件描述符不合法
+ */
+struct File *get_file(int fd) {
+    struct FdArray *fdt = current->files->fdt;
+    if (fd < 0 || fd >= fdt->max_fds) {
+        return NULL;
+    }
+    return fdt->fd[fd];
+}
+
+/**
+ * 在最小的空闲文件描述符处放入 `file`，接管调用者持有的引用
+ *
+ * @param file 可以为 NULL，只占用文件描述符，之后再填入
+ * @return 文件描述符，-1 表示表已满
+ */
+int alloc_fd(struct FileTable *files, struct File *file) {
+    struct FdArray *fdt = files->fdt;
+    int fd = -1;
+    for (int w = 0; w < fdt->max_fds / 64; ++w) {
+        if (~fdt->open_fds[w]) {
+            fd = w * 64 + lowest_bit(~fdt->open_fds[w]);
+            break;
+        }
+    }
+    if (fd == -1) {
+        if (fdt->max_fds == NR_OPEN) {
+            return -1;
+        }
+        fd = fdt->max_fds;
+    }
+    fdt = fdt_for_write(files, fd + 1);
+    fdt->open_fds[fd / 64] |= 1UL << (fd % 64);
+    fdt->fd[fd] = file;
+    return fd;
+}
+
+/**
+ * 在文件描述符 `fd` 处放入 `file`，接管调用者持有的引用，原来的文件被关闭
+ *
+ * @return -1 表示文件描述符超出范围
+ */
+int install_fd(struct FileTable *files, int fd, struct File *file) {
+    if (fd < 0 || fd >= NR_OPEN) {
+        close_file(file);
+        return -1;
+    }
+    struct FdArray *fdt = fdt_for_write(files, fd + 1);
+    close_file(fdt->fd[fd]);
+    fdt->fd[fd] = file;
+    if (file) {
+        fdt->open_fds[fd / 64] |= 1UL << (fd % 64);
+    } else {
+        fdt->open_fds[fd / 64] &= ~(1UL << (fd % 64));
+    }
+    return fd;
+}
+
+/**
+ * 关闭文件描述符
+ */
+void close_fd(struct FileTable *files, int fd) { install_fd(files, fd, NULL); }
+
+/**
+ * 新建打开文件表，包含 stdin、stdout、stderr
+ */
+struct FileTable *new_file_table() {
+    struct FileTable *files =
+        (struct FileTable *)alloc(sizeof(struct FileTable));
+    files->count = 1;
+    files->fdt = alloc_fdt(NR_OPEN_DEFAULT);
+    for (int i = 0; i < 3; ++i) {
+        struct File *stdio = (struct File *)alloc(sizeof(struct File));
+        stdio->type = FILE_STDIO;
+        stdio->count = 1;
+        stdio->inode = NULL;
+        stdio->pipe = NULL;
+        alloc_fd(files, stdio);
+    }
+    return files;
+}
+
+/**
+ * 复制打开文件表，两个表共享文件描述符数组，任一方修改时再复制
+ */
+struct FileTable *copy_file_table(struct FileTable *src) {
+    struct FileTable *files =
+        (struct FileTable *)alloc(sizeof(struct FileTable));
+    files->count = 1;
+    files->fdt = src->fdt;
+    ++files->fdt->count;
+    return files;
+}
+
+/**
+ * 释放打开文件表的引用，最后一个引用释放时关闭所有文件
+ */
+void put_file_table(struct FileTable *files) {
+    if (--files->count) {
+        return;
+    }
+    put_fdt(files->fdt);
+    dealloc((void *)files, sizeof(struct FileTable));
+}
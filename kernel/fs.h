@@ -9,8 +9,16 @@
 
 #define O_CREATE 0x200
 
+// 打开文件表初始的文件数，不够时按倍数扩充
+#define NR_OPEN_DEFAULT 64
+// 每个打开文件表的最大文件数
+#define NR_OPEN 1024
+
 #define FILE_INODE 0
 #define FILE_STDIO 1
+#define FILE_PIPE 2
+
+struct Pipe;
 
 struct SuperBlock {
     uint32 magic;         // 魔数
@@ -31,6 +39,31 @@ struct File {
     int count;
     int off;
     struct Inode *inode;
+    // 管道文件指向的管道，writable 表示是否为写端
+    struct Pipe *pipe;
+    int writable;
+};
+
+/**
+ * 文件描述符数组，fork 之后父子进程写时复制
+ */
+struct FdArray {
+    // 共享该数组的打开文件表数
+    int count;
+    // fd 数组的长度，为 64 的倍数
+    int max_fds;
+    struct File **fd;
+    // 已使用的文件描述符位图
+    usize *open_fds;
+};
+
+/**
+ * 打开文件表，同一进程的线程之间共享
+ */
+struct FileTable {
+    // 共享该表的线程数
+    int count;
+    struct FdArray *fdt;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "types.h"
+#include "def.h"
+#include "consts.h"
+#include "syscall.h"
+#include "process.h"
+
+#define FUTEX_HASH_BITS 6
+#define FUTEX_HASH_SIZE (1 << FUTEX_HASH_BITS)
+
+extern struct ProcessControlBlock *current;
+
+/**
+ * 在 futex 上等待的进程，分配在等待进程的内核栈上
+ */
+struct FutexWaiter {
+    // 用户字的物理地址，不同地址空间映射同一物理页时也能匹配
+    usize key;
+    struct ProcessControlBlock *process;
+    struct list_head list;
+};
+
+// 以物理地址散列的等待队列
+static struct list_head futex_queues[FUTEX_HASH_SIZE];
+
+void init_futex() {
+    for (int i = 0; i < FUTEX_HASH_SIZE; ++i) {
+        INIT_LIST_HEAD(&futex_queues[i]);
+    }
+}
+
+static inline struct list_head *futex_queue(usize key) {
+    return &futex_queues[((key >> 2) ^ (key >> 12)) & (FUTEX_HASH_SIZE - 1)];
+}
+
+/**
+ * 计算用户字的 futex 键
+ *
+ * @return 0 表示地址非法
+ */
+static usize futex_key(usize uaddr) {
+    if (uaddr & (sizeof(uint32) - 1)) {
+        return 0;
+    }
+    return translate(current->mm, uaddr);
+}
+
+/**
+ * 若 `uaddr` 处的值仍为 `val` 则阻塞，直到被 FUTEX_WAKE 唤醒
+ */
+static int futex_wait(usize uaddr, uint32 val) {
+    usize key = futex_key(uaddr);
+    if (!key) {
+        return -1;
+    }
+    // 内核不可抢占，检查与睡眠之间不会有其他进程修改该值并唤醒
+    if (*(uint32 *)uaddr != val) {
+        return -1;
+    }
+    struct FutexWaiter waiter;
+    waiter.key = key;
+    waiter.process = current;
+    list_add_tail(&waiter.list, futex_queue(key));
+    while (!list_empty(&waiter.list)) {
+        if (current->killed) {
+            list_del(&waiter.list);
+            return -1;
+        }
+        block_current();
+    }
+    return 0;
+}
+
+/**
+ * 唤醒至多 `count` 个在 `uaddr` 上等待的进程
+ *
+ * @return 唤醒的进程数
+ */
+static int futex_wake(usize uaddr, int count) {
+    usize key = futex_key(uaddr);
+    if (!key) {
+        return -1;
+    }
+    int woken = 0;
+    struct list_head *queue = futex_queue(key);
+    struct list_head *pos = queue->next;
+    while (pos != queue && woken < count) {
+        struct FutexWaiter *waiter = list_entry(pos, struct FutexWaiter, list);
+        pos = pos->next;
+        if (waiter->key == key) {
+            list_del(&waiter->list);
+            wake_process(waiter->process);
+            ++woken;
+        }
+    }
+    return woken;
+}
+
+int sys_futex(usize uaddr, int op, usize val) {
+    switch (op) {
+    case FUTEX_WAIT:
+        return futex_wait(uaddr, val);
+    case FUTEX_WAKE:
+        return futex_wake(uaddr, val);
+    default:
+        return -1;
+    }
+}
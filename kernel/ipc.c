@@ -0,0 +1,138 @@
+#include "types.h"
+#include "def.h"
+#include "process.h"
+
+/**
+ * 同步消息传递
+ *
+ * 消息为 a1~a4 四个寄存器，直接在双方的 Trap 上下文之间复制。
+ * ipc_call 发送消息并等待回复，ipc_reply_wait 回复上一个调用者并等待
+ * 下一条消息。对方已在等待时不经过调度队列，直接切换过去并让出时间片
+ */
+
+// 消息的第一个字所在的寄存器 a1
+#define IPC_MSG_BASE 11
+
+extern struct ProcessControlBlock *current;
+
+/**
+ * 将 `sender` 的消息交给 `receiver`，`sender` 转为等待回复
+ */
+static void ipc_deliver(struct ProcessControlBlock *sender,
+                        struct ProcessControlBlock *receiver) {
+    for (int i = 0; i < IPC_MSG_WORDS; ++i) {
+        receiver->trap_cx.x[IPC_MSG_BASE + i] =
+            sender->trap_cx.x[IPC_MSG_BASE + i];
+    }
+    receiver->ipc_from = sender->pid;
+    receiver->ipc_state = IpcNone;
+    sender->ipc_state = IpcCalling;
+}
+
+/**
+ * 唤醒 `next` 并阻塞当前进程，`next` 被阻塞时直接切换过去
+ */
+static void ipc_switch(struct ProcessControlBlock *next) {
+    if (next->state == Blocked) {
+        handoff(next);
+    } else {
+        // 对方已被其他途径唤醒，在调度队列中
+        block_current();
+    }
+}
+
+/**
+ * 向 `pid` 发送消息并等待回复，消息和回复都在 a1~a4 中
+ *
+ * @return 0 表示成功，-1 表示对方不存在或已退出
+ */
+int sys_ipc_call(int pid) {
+    struct ProcessControlBlock *target = find_process(pid);
+    if (!target || target == current || !target->mm ||
+        target->state == Exited) {
+        return -1;
+    }
+    current->ipc_partner = target;
+    current->ipc_state = IpcSending;
+    list_add_tail(&current->ipc_link, &target->ipc_waiters);
+    if (target->ipc_state == IpcReceiving) {
+        ipc_deliver(current, target);
+        ipc_switch(target);
+    }
+    while (current->ipc_state != IpcNone) {
+        if (!current->ipc_partner) {
+            // 对方已退出，已将当前进程移出等待链表
+            current->ipc_state = IpcNone;
+            return -1;
+        }
+        if (current->killed) {
+            list_del(&current->ipc_link);
+            current->ipc_state = IpcNone;
+            current->ipc_partner = NULL;
+            return -1;
+        }
+        block_current();
+    }
+    return 0;
+}
+
+/**
+ * 回复 `reply_to` 并等待下一条消息，回复和收到的消息都在 a1~a4 中
+ *
+ * @param reply_to 要回复的调用者，0 表示只等待消息
+ * @return 消息的发送者，-1 表示 `reply_to` 没有在等待回复或被 kill
+ */
+int sys_ipc_reply_wait(int reply_to) {
+    struct ProcessControlBlock *caller = NULL;
+    if (reply_to) {
+        caller = find_process(reply_to);
+        if (!caller || caller->ipc_state != IpcCalling ||
+            caller->ipc_partner != current) {
+            return -1;
+        }
+        for (int i = 0; i < IPC_MSG_WORDS; ++i) {
+            caller->trap_cx.x[IPC_MSG_BASE + i] =
+                current->trap_cx.x[IPC_MSG_BASE + i];
+        }
+        list_del(&caller->ipc_link);
+        caller->ipc_state = IpcNone;
+        caller->ipc_partner = NULL;
+    }
+    // 已有排队的发送者时直接接收，调用者回到调度队列
+    struct ProcessControlBlock *sender;
+    list_for_each_entry(sender, &current->ipc_waiters, ipc_link) {
+        if (sender->ipc_state == IpcSending) {
+            ipc_deliver(sender, current);
+            if (caller) {
+                wake_process(caller);
+            }
+            return current->ipc_from;
+        }
+    }
+    current->ipc_state = IpcReceiving;
+    if (caller) {
+        ipc_switch(caller);
+    }
+    while (current->ipc_state == IpcReceiving) {
+        if (current->killed) {
+            current->ipc_state = IpcNone;
+            return -1;
+        }
+        block_current();
+    }
+    return current->ipc_from;
+}
+
+/**
+ * 进程退出时让所有向其发送消息或等待其回复的进程返回失败
+ */
+void ipc_exit(struct ProcessControlBlock *process) {
+    while (!list_empty(&process->ipc_waiters)) {
+        struct ProcessControlBlock *waiter = list_entry(
+            process->ipc_waiters.next, struct ProcessControlBlock, ipc_link);
+        list_del(&waiter->ipc_link);
+        waiter->ipc_partner = NULL;
+        wake_process(waiter);
+    }
+    process->ipc_state = IpcNone;
+}
@@ -0,0 +1,55 @@
+#include "types.h"
+#include "def.h"
+#include "kthread.h"
+#include "process.h"
+
+extern int need_resched;
+
+// 等待 kworker 执行的工作
+static struct list_head work_list;
+static struct WaitQueue work_wait;
+
+/**
+ * 依次执行工作队列中的工作，没有工作时睡眠
+ */
+static void kworker(void *arg) {
+    while (1) {
+        while (list_empty(&work_list)) {
+            sleep_on(&work_wait);
+        }
+        struct Work *work = list_entry(work_list.next, struct Work, list);
+        list_del(&work->list);
+        work->func(work);
+        cond_resched();
+    }
+}
+
+/**
+ * 将工作交给 kworker 在后台执行
+ */
+void schedule_work(struct Work *work) {
+    list_add_tail(&work->list, &work_list);
+    wakeup(&work_wait);
+}
+
+/**
+ * 长时间运行的内核线程主动检查是否需要让出 CPU
+ *
+ * 短暂打开抢占窗口处理挂起的时钟中断
+ */
+void cond_resched() {
+    preempt_enable();
+    preempt_disable();
+    if (need_resched) {
+        yield();
+    }
+}
+
+void init_kthreads() {
+    INIT_LIST_HEAD(&work_list);
+    init_wait_queue(&work_wait);
+    kthread_create(kworker, NULL, PRIO_NORMAL, "kworker");
+    // 只在没有其他进程运行时清零页帧
+    kthread_create(kzerod, NULL, PRIO_LOW, "kzerod");
+    printf("***** Init Kernel Threads *****\n");
+}
@@ -0,0 +1,21 @@
+#ifndef _KTHREAD_H
+#define _KTHREAD_H
+
+#include "types.h"
+#include "list.h"
+
+/**
+ * 推迟到 kworker 内核线程中执行的工作
+ */
+struct Work {
+    // 在 kworker 中调用，可以阻塞
+    void (*func)(struct Work *);
+    struct list_head list;
+};
+
+static inline void init_work(struct Work *work, void (*func)(struct Work *)) {
+    work->func = func;
+    INIT_LIST_HEAD(&work->list);
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "types.h"
 #include "def.h"
 #include "consts.h"
+#include "riscv.h"
 
 inline void *wrap_alloc(usize size) {
     extern uint64 next_power_of_two(uint64);
@@ -43,7 +44,35 @@ void test_alloc() {
     printf("Buddy test passed!\n");
 }
 
-void main() {
+/**
+ * 测量重新设置时钟比较值的开销，每次进程切换都要付出这一开销
+ */
+void bench_timer() {
+    extern int has_sstc;
+    const int rounds = 1000;
+    usize start = r_time();
+    for (int i = 0; i < rounds; ++i) {
+        set_timer(-1);
+    }
+    usize sbi = r_time() - start;
+    printf("Timer reprogram via SBI: %d ns\n",
+           (int)(ticks_to_ns(sbi) / rounds));
+    if (has_sstc) {
+        start = r_time();
+        for (int i = 0; i < rounds; ++i) {
+            w_stimecmp(-1);
+        }
+        usize csr = r_time() - start;
+        printf("Timer reprogram via stimecmp: %d ns\n",
+               (int)(ticks_to_ns(csr) / rounds));
+    }
+}
+
+/**
+ * @param hartid 当前硬件线程号
+ * @param dtb 设备树物理地址
+ */
+void main(usize hartid, usize dtb) {
     /* 初始化 .bss 段 */
     uint64 *bss_start_init = (uint64 *)sbss, *bss_end_init = (uint64 *)ebss;
     for (volatile uint64 *bss_mem = bss_start_init; bss_mem < bss_end_init;
@@ -51,10 +80,20 @@ void main() {
         *bss_mem = 0;
     }
 
+    // 设备树可能被内存分配器覆盖，需最先解析
+    probe_timer(dtb);
     init_memory();
     test_alloc();
     init_fs();
+    init_console();
+    init_futex();
+    init_shm();
     init_trap();
+    init_plic();
+    init_vdso();
+    test_timer();
+    bench_timer();
+    init_acct();
     init_process();
     shutdown();
 }
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include "def.h"
 #include "consts.h"
 #include "mapping.h"
+#include "riscv.h"
+
+// 只映射内核的地址空间
+static struct MemoryMap *kernel_mm = NULL;
 
 /**
  * 以虚拟页号遍历虚拟地址范围
@@ -16,6 +20,9 @@
 struct MemoryMap *new_memory_map() {
     struct MemoryMap *res = (struct MemoryMap *)alloc(sizeof(struct MemoryMap));
     res->root_ppn = alloc_frame();
+    res->count = 1;
+    res->stack_slots = 0;
+    res->ring = NULL;
     INIT_LIST_HEAD(&res->segment_list);
     return res;
 }
@@ -27,6 +34,8 @@ struct Segment *new_segment(usize start_va, usize end_va, usize flags,
     res->end_va = end_va;
     res->flags = flags;
     res->type = type;
+    res->ppn = 0;
+    res->shm = NULL;
     INIT_LIST_HEAD(&res->list);
     return res;
 }
@@ -71,6 +80,19 @@ PageTableEntry *find_entry(usize root_ppn, usize vpn, int flag) {
     return pte;
 }
 
+/**
+ * 将地址空间中的用户虚拟地址翻译为物理地址
+ *
+ * @return 0 表示该地址没有映射或用户不可访问
+ */
+usize translate(struct MemoryMap *mm, usize va) {
+    PageTableEntry *entry = find_entry(mm->root_ppn, va >> 12, 0);
+    if (!entry || !(*entry & PAGE_VALID) || !(*entry & PAGE_USER)) {
+        return 0;
+    }
+    return PTE2PA(*entry) | (va & (PAGE_SIZE - 1));
+}
+
 /**
  * 将虚拟地址映射为物理地址
  *
@@ -92,6 +114,25 @@ void map_pages(usize root_ppn, usize start_va, usize start_pa, int size,
     }
 }
 
+/**
+ * 取消虚拟地址范围的映射，不释放物理页
+ *
+ * @param root_ppn 根页表物理地址
+ * @param start_va 开始取消映射的虚拟地址
+ * @param size 取消映射的大小
+ */
+void unmap_pages(usize root_ppn, usize start_va, int size) {
+    usize vpn;
+    list_for_va_range(vpn, start_va, start_va + size) {
+        PageTableEntry *entry = find_entry(root_ppn, vpn, 0);
+        if (entry) {
+            *entry = 0;
+        }
+    }
+    // 地址空间可能正被其他线程使用，刷新 TLB
+    asm volatile("sfence.vma" :::);
+}
+
 /**
  * 映射一个段，填充页表。
  *
@@ -108,7 +149,14 @@ void map_segment(usize root_ppn, struct Segment *segment, char *data,
         if (*entry != 0) {
             panic("[map_segment] Virtual address already mapped!\n");
         }
-        usize ppn = segment->type == Linear ? __ppn(vpn) : alloc_frame();
+        usize ppn;
+        if (segment->type == Linear) {
+            ppn = __ppn(vpn);
+        } else if (segment->type == Shared) {
+            ppn = segment->ppn + vpn - (segment->start_va >> 12);
+        } else {
+            ppn = alloc_frame();
+        }
 #ifdef D1
         segment->flags |= PAGE_ACCESS | PAGE_DIRTY;
 #endif
@@ -116,9 +164,11 @@ void map_segment(usize root_ppn, struct Segment *segment, char *data,
         if (data) { // 复制数据到目标位置
             char *dst = (char *)__va(ppn << 12);
             usize size = len >= PAGE_SIZE ? PAGE_SIZE : len;
+            preempt_enable();
             for (int i = 0; i < size; ++i) {
                 dst[i] = data[i];
             }
+            preempt_disable();
             data += size;
             len -= size;
         }
@@ -132,7 +182,10 @@ void map_segment(usize root_ppn, struct Segment *segment, char *data,
  * @param segment 需释放的段
  */
 void unmap_segment(usize root_ppn, struct Segment *segment) {
-    if (segment->type == Linear) {
+    if (segment->shm) {
+        shm_put(segment->shm);
+    }
+    if (segment->type != Framed) {
         return;
     }
     usize vpn;
@@ -178,15 +231,46 @@ void activate_pagetable(usize root_ppn) {
  * 释放进程地址空间
  */
 void dealloc_memory_map(struct MemoryMap *mm) {
+    // 切换到内核线程时沿用了原页表，页表可能仍在使用，先切换回内核页表
+    if (r_satp() == __satp(mm->root_ppn)) {
+        activate_pagetable(kernel_mm->root_ppn);
+    }
+    ring_free(mm->ring);
     struct Segment *seg;
     while (!list_empty(&mm->segment_list)) {
         list_for_each_entry(seg, &mm->segment_list, list) {
             list_del(&seg->list);
             unmap_segment(mm->root_ppn, seg);
+            dealloc((void *)seg, sizeof(struct Segment));
             break;
         }
     }
     dealloc_pagetable(mm->root_ppn);
+    dealloc((void *)mm, sizeof(struct MemoryMap));
+}
+
+/**
+ * 增加地址空间的引用
+ */
+struct MemoryMap *mm_get(struct MemoryMap *mm) {
+    ++mm->count;
+    return mm;
+}
+
+static void free_mm_work(struct Work *work) {
+    dealloc_memory_map(container_of(work, struct MemoryMap, free_work));
+}
+
+/**
+ * 释放地址空间的引用
+ *
+ * 最后一个引用释放时交给 kworker 回收整个地址空间，不占用系统调用的时间
+ */
+void mm_put(struct MemoryMap *mm) {
+    if (!--mm->count) {
+        init_work(&mm->free_work, free_mm_work);
+        schedule_work(&mm->free_work);
+    }
 }
 
 /**
@@ -198,24 +282,47 @@ struct MemoryMap *copy_mm(struct MemoryMap *src) {
     list_for_each_entry(src_seg, &src->segment_list, list) {
         struct Segment *dst_seg = new_segment(
             src_seg->start_va, src_seg->end_va, src_seg->flags, src_seg->type);
+        dst_seg->ppn = src_seg->ppn;
+        if (src_seg->shm) {
+            dst_seg->shm = shm_get(src_seg->shm);
+        }
         map_segment(dst->root_ppn, dst_seg, NULL, 0);
-        if (dst_seg->type == Linear)
+        list_add_tail(&dst_seg->list, &dst->segment_list);
+        // 只有 Framed 段需要复制数据，其他段映射相同的物理页
+        if (dst_seg->type != Framed) {
             continue;
+        }
         usize vpn;
         list_for_va_range(vpn, src_seg->start_va, src_seg->end_va) {
             char *src_page =
                 (char *)__va(PTE2PA(*find_entry(src->root_ppn, vpn, 0)));
             char *dst_page =
                 (char *)__va(PTE2PA(*find_entry(dst->root_ppn, vpn, 0)));
+            // 复制页面期间允许被抢占
+            preempt_enable();
             for (int i = 0; i < PAGE_SIZE; ++i) {
                 dst_page[i] = src_page[i];
             }
+            preempt_disable();
         }
-        list_add_tail(&dst_seg->list, &dst->segment_list);
     }
+    dst->ring = ring_dup(src->ring);
     return dst;
 }
 
+#ifdef QEMU
+/**
+ * 映射一页设备寄存器
+ */
+static void map_mmio(struct MemoryMap *mm, usize pa) {
+    struct Segment *segment =
+        new_segment(__va(pa), __va(pa) + PAGE_SIZE,
+                    PAGE_VALID | PAGE_READ | PAGE_WRITE, Linear);
+    map_segment(mm->root_ppn, segment, NULL, 0);
+    list_add(&segment->list, &mm->segment_list);
+}
+#endif
+
 /**
  * 新建内核地址空间
  */
@@ -250,6 +357,14 @@ struct MemoryMap *new_kernel_memory_map() {
                     PAGE_VALID | PAGE_READ | PAGE_WRITE, Linear);
     map_segment(mm->root_ppn, other, NULL, 0);
 
+#ifdef QEMU
+    // 串口和 PLIC 的寄存器（hart 0 的 S 态上下文），rw-
+    map_mmio(mm, UART0);
+    map_mmio(mm, PLIC);
+    map_mmio(mm, PLIC + 0x2000);
+    map_mmio(mm, PLIC + 0x201000);
+#endif
+
     // 连接各个映射区域
     list_add(&other->list, &mm->segment_list);
     list_add(&bss->list, &mm->segment_list);
@@ -266,6 +381,7 @@ struct MemoryMap *new_kernel_memory_map() {
 struct MemoryMap *remap_kernel() {
     struct MemoryMap *mm = new_kernel_memory_map();
     activate_pagetable(mm->root_ppn);
+    kernel_mm = mm;
     printf("***** Remap Kernel *****\n");
     return mm;
 }
\ No newline at end of file
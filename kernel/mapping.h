@@ -4,6 +4,7 @@
 #include "types.h"
 #include "consts.h"
 #include "list.h"
+#include "kthread.h"
 
 #define __va(pa) ((pa) + KERNEL_MAP_OFFSET)
 #define __pa(va) ((va)-KERNEL_MAP_OFFSET)
@@ -25,9 +26,16 @@
 #define PAGE_ACCESS (1 << 6)
 #define PAGE_DIRTY (1 << 7)
 
+struct RingCtx;
+struct Shm;
+
 enum SegmentType {
+    // 线性映射内核地址
     Linear,
+    // 映射新分配的页帧，随地址空间释放
     Framed,
+    // 映射指定的物理页，多个地址空间共享，不随地址空间释放
+    Shared,
 };
 
 typedef usize PageTableEntry;
@@ -43,6 +51,10 @@ struct Segment {
     // 映射的权限标志
     usize flags;
     enum SegmentType type;
+    // Shared 段映射的起始物理页号
+    usize ppn;
+    // 映射共享内存对象时持有其引用，否则为 NULL
+    struct Shm *shm;
     struct list_head list;
 };
 
@@ -52,7 +64,15 @@ struct Segment {
 struct MemoryMap {
     // 根页表的物理页号
     usize root_ppn;
+    // 共享该地址空间的线程数
+    int count;
+    // 已使用的用户栈槽位图
+    usize stack_slots;
     struct list_head segment_list;
+    // 批量系统调用队列，没有建立时为 NULL
+    struct RingCtx *ring;
+    // 最后一个引用释放后，在 kworker 中回收
+    struct Work free_work;
 };
 
 #endif
\ No newline at end of file
@@ -3,9 +3,18 @@
 #include "buddy_system_allocator.h"
 #include "mapping.h"
 #include "riscv.h"
+#include "process.h"
 
 static struct Buddy allocator;
 
+// 预先清零的页帧池，由低优先级的 kzerod 在空闲时填充
+#define ZERO_POOL_SIZE 32
+// 页帧池少于该数量时唤醒 kzerod
+#define ZERO_POOL_LOW 8
+static usize zero_pool[ZERO_POOL_SIZE];
+static int nr_zeroed = 0;
+static struct WaitQueue zero_wait;
+
 void init_allocator() {
     init_buddy(&allocator);
     add_to_buddy(&allocator, (void *)ekernel, (void *)__va(MEMORY_END));
@@ -36,17 +45,48 @@ void dealloc(void *block, usize size) {
     buddy_dealloc(&allocator, block, size);
 }
 
+/**
+ * 分配一个清零的页帧并返回其内核地址
+ */
+static char *alloc_zeroed_page() {
+    char *page = (char *)alloc(PAGE_SIZE);
+    for (int i = 0; i < PAGE_SIZE; ++i) {
+        page[i] = 0;
+    }
+    return page;
+}
+
 /**
  * 分配一个物理页帧
  *
+ * 优先从预先清零的页帧池中取
+ *
  * @return 物理页帧号
  */
 usize alloc_frame() {
-    char *page = (char *)alloc(PAGE_SIZE);
-    for (int i = 0; i < PAGE_SIZE; ++i) {
-        page[i] = 0;
+    usize ppn;
+    if (nr_zeroed) {
+        ppn = zero_pool[--nr_zeroed];
+    } else {
+        ppn = __pa((usize)alloc_zeroed_page()) >> 12;
+    }
+    if (nr_zeroed < ZERO_POOL_LOW) {
+        wakeup(&zero_wait);
+    }
+    return ppn;
+}
+
+/**
+ * 清零页帧的内核线程，填满页帧池后睡眠
+ */
+void kzerod(void *args) {
+    while (1) {
+        while (nr_zeroed == ZERO_POOL_SIZE) {
+            sleep_on(&zero_wait);
+        }
+        zero_pool[nr_zeroed++] = __pa((usize)alloc_zeroed_page()) >> 12;
+        cond_resched();
     }
-    return __pa((usize)page) >> 12;
 }
 
 /**
@@ -58,6 +98,7 @@ void dealloc_frame(usize ppn) { dealloc((void *)__va(ppn << 12), PAGE_SIZE); }
 
 void init_memory() {
     init_allocator();
+    init_wait_queue(&zero_wait);
     // 打开 sstatus 的 SUM 位，允许内核访问用户内存
     w_sstatus(r_sstatus() | SSTATUS_SUM);
     printf("***** Init Memory *****\n");
@@ -0,0 +1,138 @@
+#include "types.h"
+#include "def.h"
+#include "fs.h"
+#include "pipe.h"
+#include "process.h"
+#include "syscall.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+extern struct ProcessControlBlock *current;
+
+static struct File *pipe_file(struct Pipe *pipe, int writable) {
+    struct File *file = (struct File *)alloc(sizeof(struct File));
+    file->type = FILE_PIPE;
+    file->count = 1;
+    file->off = 0;
+    file->inode = NULL;
+    file->pipe = pipe;
+    file->writable = writable;
+    return file;
+}
+
+/**
+ * 创建管道，fds[0] 为读端，fds[1] 为写端
+ *
+ * @return -1 表示没有空闲的文件描述符
+ */
+int sys_pipe(int *fds) {
+    struct FileTable *files = current->files;
+    int rfd = alloc_fd(files, NULL);
+    if (rfd == -1) {
+        return -1;
+    }
+    int wfd = alloc_fd(files, NULL);
+    if (wfd == -1) {
+        close_fd(files, rfd);
+        return -1;
+    }
+    struct Pipe *pipe = (struct Pipe *)alloc(sizeof(struct Pipe));
+    pipe->buf = (char *)alloc(PIPE_SIZE);
+    pipe->r = pipe->w = 0;
+    pipe->readers = pipe->writers = 1;
+    init_wait_queue(&pipe->read_wait);
+    init_wait_queue(&pipe->write_wait);
+    files->fdt->fd[rfd] = pipe_file(pipe, 0);
+    files->fdt->fd[wfd] = pipe_file(pipe, 1);
+    fds[0] = rfd;
+    fds[1] = wfd;
+    return 0;
+}
+
+/**
+ * 从管道读取至多 `count` 字节，缓冲区为空时阻塞
+ *
+ * @return 读取的字节数，0 表示写端已全部关闭
+ */
+int pipe_read(struct Pipe *pipe, char *buf, int count) {
+    while (pipe->r == pipe->w) {
+        if (!pipe->writers) {
+            return 0;
+        }
+        if (current->killed) {
+            return -1;
+        }
+        sleep_on(&pipe->read_wait);
+    }
+    int num = MIN(count, pipe->w - pipe->r);
+    for (int i = 0; i < num; ++i) {
+        buf[i] = pipe->buf[pipe->r++ % PIPE_SIZE];
+    }
+    wakeup(&pipe->write_wait);
+    return num;
+}
+
+/**
+ * 向管道写入 `count` 字节，缓冲区满时阻塞直到全部写入
+ *
+ * @return 写入的字节数，读端已全部关闭时返回 -1
+ */
+int pipe_write(struct Pipe *pipe, char *buf, int count) {
+    int num = 0;
+    while (num < count) {
+        if (!pipe->readers || current->killed) {
+            return num ? num : -1;
+        }
+        if (pipe->w - pipe->r == PIPE_SIZE) {
+            sleep_on(&pipe->write_wait);
+            continue;
+        }
+        int len = MIN(count - num, PIPE_SIZE - (pipe->w - pipe->r));
+        for (int i = 0; i < len; ++i) {
+            pipe->buf[pipe->w++ % PIPE_SIZE] = buf[num++];
+        }
+        wakeup(&pipe->read_wait);
+    }
+    return num;
+}
+
+/**
+ * 查询管道一端的就绪状态
+ */
+short pipe_poll(struct Pipe *pipe, int writable, struct PollTable *pt) {
+    short mask = 0;
+    if (writable) {
+        poll_wait(pt, &pipe->write_wait);
+        if (!pipe->readers) {
+            mask |= POLLHUP;
+        } else if (pipe->w - pipe->r < PIPE_SIZE) {
+            mask |= POLLOUT;
+        }
+    } else {
+        poll_wait(pt, &pipe->read_wait);
+        if (pipe->r != pipe->w) {
+            mask |= POLLIN;
+        }
+        if (!pipe->writers) {
+            mask |= POLLHUP;
+        }
+    }
+    return mask;
+}
+
+/**
+ * 关闭管道的一端，两端都关闭后释放管道
+ */
+void pipe_close(struct Pipe *pipe, int writable) {
+    if (writable) {
+        --pipe->writers;
+        wakeup(&pipe->read_wait);
+    } else {
+        --pipe->readers;
+        wakeup(&pipe->write_wait);
+    }
+    if (!pipe->readers && !pipe->writers) {
+        dealloc(pipe->buf, PIPE_SIZE);
+        dealloc((void *)pipe, sizeof(struct Pipe));
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef _PIPE_H
+#define _PIPE_H
+
+#include "types.h"
+#include "consts.h"
+#include "process.h"
+
+// 管道缓冲区大小为一页
+#define PIPE_SIZE PAGE_SIZE
+
+/**
+ * 管道，读端和写端各为一个打开文件
+ *
+ * 缓冲区为环形队列，r 和 w 只增不减，取模得到缓冲区中的位置
+ */
+struct Pipe {
+    char *buf;
+    usize r;
+    usize w;
+    // 打开的读端和写端数量
+    int readers;
+    int writers;
+    // 缓冲区为空时读者在 read_wait 上等待，满时写者在 write_wait 上等待
+    struct WaitQueue read_wait;
+    struct WaitQueue write_wait;
+};
+
+#endif
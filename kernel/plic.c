@@ -0,0 +1,50 @@
+#include "types.h"
+#include "def.h"
+#include "consts.h"
+#include "riscv.h"
+#include "mapping.h"
+
+/**
+ * PLIC 外部中断控制器，目前只用于 QEMU 上的串口输入中断
+ *
+ * 只使用 hart 0 的 S 态上下文
+ */
+
+#ifdef QEMU
+#define PLIC_PRIORITY(irq) (__va(PLIC) + (irq)*4)
+#define PLIC_SENABLE (__va(PLIC) + 0x2080)
+#define PLIC_STHRESHOLD (__va(PLIC) + 0x201000)
+#define PLIC_SCLAIM (__va(PLIC) + 0x201004)
+
+#define REG(addr) (*(volatile uint32 *)(addr))
+
+void init_plic() {
+    REG(PLIC_PRIORITY(UART0_IRQ)) = 1;
+    REG(PLIC_SENABLE) = 1 << UART0_IRQ;
+    // 接受所有优先级大于 0 的中断
+    REG(PLIC_STHRESHOLD) = 0;
+    w_sie(r_sie() | SIE_SEIE);
+    console_enable_irq();
+    printf("***** Init PLIC *****\n");
+}
+
+/**
+ * 处理外部中断
+ */
+void plic_handle() {
+    uint32 irq;
+    while ((irq = REG(PLIC_SCLAIM))) {
+        if (irq == UART0_IRQ) {
+            console_intr();
+        } else {
+            printf("[plic] unexpected irq %d\n", irq);
+        }
+        REG(PLIC_SCLAIM) = irq;
+    }
+}
+#else
+// D1 上仍通过 SBI 轮询控制台输入
+void init_plic() {}
+
+void plic_handle() {}
+#endif
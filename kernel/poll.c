@@ -0,0 +1,110 @@
+#include "types.h"
+#include "def.h"
+#include "riscv.h"
+#include "fs.h"
+#include "poll.h"
+#include "process.h"
+
+extern struct ProcessControlBlock *current;
+
+/**
+ * 在等待队列 `wq` 上登记当前进程，文件就绪时被唤醒
+ *
+ * @param pt 为 NULL 时只查询，不登记
+ */
+void poll_wait(struct PollTable *pt, struct WaitQueue *wq) {
+    if (!pt || pt->n == POLL_MAX_ENTRIES) {
+        return;
+    }
+    struct WaitEntry *entry = &pt->entries[pt->n++];
+    entry->process = current;
+    list_add_tail(&entry->list, &wq->head);
+}
+
+/**
+ * 从所有登记过的等待队列中移除，再释放持有的文件引用
+ */
+static void poll_free(struct PollTable *pt) {
+    for (int i = 0; i < pt->n; ++i) {
+        list_del(&pt->entries[i].list);
+    }
+    pt->n = 0;
+    for (int i = 0; i < pt->nfiles; ++i) {
+        close_file(pt->files[i]);
+    }
+    pt->nfiles = 0;
+}
+
+static void poll_timeout(struct Timer *timer) {
+    wake_process(container_of(timer, struct ProcessControlBlock, timer));
+}
+
+/**
+ * 查询各个文件的就绪状态，填写 revents
+ *
+ * @return 就绪的文件数
+ */
+static int poll_once(struct PollFd *fds, int nfds, struct PollTable *pt) {
+    int ready = 0;
+    for (int i = 0; i < nfds; ++i) {
+        int fd = fds[i].fd;
+        struct File *file = get_file(fd);
+        short mask;
+        if (fd < 0) {
+            mask = 0;
+        } else if (!file) {
+            mask = POLLNVAL;
+        } else {
+            if (pt) {
+                ++file->count;
+                pt->files[pt->nfiles++] = file;
+            }
+            mask = file_poll(file, pt);
+        }
+        // POLLHUP 和 POLLNVAL 总是报告
+        mask &= fds[i].events | POLLHUP | POLLNVAL;
+        fds[i].revents = mask;
+        if (mask) {
+            ++ready;
+        }
+    }
+    return ready;
+}
+
+/**
+ * 等待一组文件中的任意一个就绪
+ *
+ * 每轮先在各文件的等待队列上登记再查询，没有就绪的文件时睡眠，
+ * 任一等待队列被唤醒或超时后重新查询
+ *
+ * @param timeout 超时时间（纳秒），-1 表示一直等待，0 表示只查询
+ * @return 就绪的文件数，0 表示超时，-1 表示参数不合法或被 kill
+ */
+int sys_poll(struct PollFd *fds, int nfds, usize timeout) {
+    if (nfds < 0 || nfds > POLL_MAX_FDS) {
+        return -1;
+    }
+    struct PollTable pt;
+    pt.n = 0;
+    pt.nfiles = 0;
+    int ready = poll_once(fds, nfds, NULL);
+    if (ready || !timeout) {
+        return ready;
+    }
+    if (timeout != -1) {
+        setup_timer(&current->timer, poll_timeout);
+        add_timer(&current->timer, r_time() + ns_to_ticks(timeout));
+    }
+    while (1) {
+        ready = poll_once(fds, nfds, &pt);
+        if (ready || current->killed ||
+            (timeout != -1 && !timer_pending(&current->timer))) {
+            break;
+        }
+        block_current();
+        poll_free(&pt);
+    }
+    poll_free(&pt);
+    del_timer(&current->timer);
+    return current->killed && !ready ? -1 : ready;
+}
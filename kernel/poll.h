@@ -0,0 +1,24 @@
+#ifndef _POLL_H
+#define _POLL_H
+
+#include "types.h"
+#include "fs.h"
+#include "process.h"
+
+// 一次 poll 最多等待的文件数
+#define POLL_MAX_FDS 16
+// 一个文件至多在两个等待队列上等待
+#define POLL_MAX_ENTRIES (POLL_MAX_FDS * 2)
+
+/**
+ * poll 在各个等待队列上的等待项，分配在 poll 进程的内核栈上
+ */
+struct PollTable {
+    struct WaitEntry entries[POLL_MAX_ENTRIES];
+    int n;
+    // 登记期间持有的文件引用，防止文件在睡眠时被其他线程关闭并释放
+    struct File *files[POLL_MAX_FDS];
+    int nfiles;
+};
+
+#endif
@@ -6,6 +6,8 @@
 #include "elf.h"
 #include "mapping.h"
 #include "fs.h"
+#include "bitops.h"
+#include "syscall.h"
 
 // 当前运行的进程
 struct ProcessControlBlock *current = NULL;
@@ -13,24 +15,51 @@ struct ProcessControlBlock *current = NULL;
 struct ProcessControlBlock *idle = NULL;
 // 第一个创建的进程
 struct ProcessControlBlock *init = NULL;
+// 尚未退出的用户进程数量，为 0 时系统关机
+static int nr_process = 0;
+extern int need_resched;
+extern usize max_resched_latency;
+// 各优先级的调度队列
+static struct list_head run_queue[NR_PRIO];
 
-#define MAX_PID 1024
-static int pids[MAX_PID / 32] = {0};
+/**
+ * 唤醒延迟统计：从进程被唤醒到真正开始运行经过的时间
+ */
+static struct {
+    usize count;
+    usize total;
+    usize max;
+} wakeup_latency;
+
+#define MAX_PID 32768
+#define PID_HASH_SIZE 256
+static uint32 pids[MAX_PID / 32] = {0};
+// 下一次分配 pid 开始查找的位置，循环分配以推迟 pid 的复用
+static int next_pid = 0;
+// 以 pid 散列的进程表
+static struct list_head pid_hash[PID_HASH_SIZE];
 
 /**
  * 分配 pid
+ *
+ * 从上次分配的位置开始查找，跳过已满的字，均摊 O(1)
  */
 int alloc_pid() {
-    for (int i = 0; i < MAX_PID / 32; ++i) {
-        if (pids[i] != 0xFFFFFFFF) {
-            for (int j = 0; j < 32; ++j) {
-                if ((pids[i] & (1 << j)) == 0) {
-                    // 标记为已分配
-                    pids[i] |= (1 << j);
-                    return i * 32 + j;
-                }
-            }
+    int words = MAX_PID / 32;
+    int index = next_pid / 32;
+    // 第一个字只查找提示位置之后的位
+    uint32 mask = ~0U << (next_pid % 32);
+    for (int n = 0; n <= words; ++n) {
+        uint32 free = ~pids[index] & mask;
+        if (free) {
+            int pid = index * 32 + lowest_bit(free);
+            // 标记为已分配
+            pids[index] |= 1U << (pid % 32);
+            next_pid = (pid + 1) % MAX_PID;
+            return pid;
         }
+        index = (index + 1) % words;
+        mask = ~0U;
     }
     return -1;
 }
@@ -43,12 +72,28 @@ void dealloc_pid(int pid) {
         int index = pid / 32;
         int offset = pid % 32;
         // 标记为未分配
-        pids[index] &= ~(1 << offset);
+        pids[index] &= ~(1U << offset);
     } else {
         panic("Invalid PID: %d\n", pid);
     }
 }
 
+/**
+ * 根据 pid 查找进程
+ *
+ * @return NULL 表示进程不存在
+ */
+struct ProcessControlBlock *find_process(int pid) {
+    struct ProcessControlBlock *process;
+    struct list_head *head = &pid_hash[pid & (PID_HASH_SIZE - 1)];
+    list_for_each_entry(process, head, pid_link) {
+        if (process->pid == pid) {
+            return process;
+        }
+    }
+    return NULL;
+}
+
 /**
  * 初始化设置进程上下文使其返回 __restore
  *
@@ -79,6 +124,8 @@ void goto_app(struct TrapContext *trap_cx, usize entry, usize user_sp,
     usize sstatus = r_sstatus();
     // 设置返回后的特权级为 U-Mode
     sstatus &= ~SSTATUS_SPP;
+    // 关闭 FPU，第一次使用浮点指令时再恢复浮点寄存器
+    sstatus &= ~SSTATUS_FS;
     // 中断使能
     sstatus |= SSTATUS_SPIE;
     sstatus &= ~SSTATUS_SIE;
@@ -91,45 +138,139 @@ void goto_app(struct TrapContext *trap_cx, usize entry, usize user_sp,
 }
 
 /**
- * 创建新进程
+ * 为进程分配用户栈，并映射到其地址空间中一个空闲的栈槽
+ *
+ * @param slot 指定的栈槽，-1 表示任选一个空闲的栈槽
+ * @return -1 没有空闲的栈槽
+ */
+int alloc_ustack(struct ProcessControlBlock *process, int slot) {
+    struct MemoryMap *mm = process->mm;
+    if (slot < 0) {
+        for (slot = 0; slot < MAX_STACK_SLOTS; ++slot) {
+            if (!(mm->stack_slots & (1UL << slot))) {
+                break;
+            }
+        }
+        if (slot == MAX_STACK_SLOTS) {
+            return -1;
+        }
+    }
+    mm->stack_slots |= 1UL << slot;
+    process->stack_slot = slot;
+    process->ustack = (usize)alloc(USER_STACK_SIZE);
+    map_pages(mm->root_ppn, STACK_SLOT_VA(slot), __pa(process->ustack),
+              USER_STACK_SIZE, PAGE_VALID | PAGE_USER | PAGE_READ | PAGE_WRITE);
+    return 0;
+}
+
+/**
+ * 释放进程的用户栈
+ *
+ * 地址空间仍被其他线程使用时需要取消映射，否则随地址空间一起回收
+ */
+void dealloc_ustack(struct ProcessControlBlock *process) {
+    struct MemoryMap *mm = process->mm;
+    if (mm->count > 1) {
+        unmap_pages(mm->root_ppn, STACK_SLOT_VA(process->stack_slot),
+                    USER_STACK_SIZE);
+    }
+    mm->stack_slots &= ~(1UL << process->stack_slot);
+    dealloc((void *)process->ustack, USER_STACK_SIZE);
+}
+
+/**
+ * 用户栈栈顶的虚拟地址
+ */
+static inline usize ustack_top(struct ProcessControlBlock *process) {
+    return STACK_SLOT_VA(process->stack_slot) + USER_STACK_SIZE;
+}
+
+/**
+ * 设置进程名，过长时截断
+ */
+static void set_name(struct ProcessControlBlock *process, char *name) {
+    int i = 0;
+    for (; i < PROC_NAME_LEN - 1 && name[i]; ++i) {
+        process->name[i] = name[i];
+    }
+    process->name[i] = '\0';
+}
+
+/**
+ * 分配并初始化进程控制块中与地址空间无关的部分
  */
-struct ProcessControlBlock *new_process(char *elf) {
+struct ProcessControlBlock *alloc_process() {
     struct ProcessControlBlock *res =
         (struct ProcessControlBlock *)alloc(sizeof(struct ProcessControlBlock));
     res->pid = alloc_pid();
+    if (res->pid < 0) {
+        panic("No free PID!\n");
+    }
+    list_add(&res->pid_link, &pid_hash[res->pid & (PID_HASH_SIZE - 1)]);
+    res->tgid = res->pid;
     res->state = Ready;
+    res->prio = PRIO_NORMAL;
+    res->killed = 0;
+    res->preempt_count = 1;
+    res->wake_time = 0;
+    res->utime = res->stime = res->cycles = res->instret = 0;
+    res->sysstat = NULL;
+    res->traced = 0;
+    res->name[0] = '\0';
+    INIT_LIST_HEAD(&res->timer.list);
+    for (int i = 0; i < 32; ++i) {
+        res->fpu_cx.f[i] = 0;
+    }
+    res->fpu_cx.fcsr = 0;
+    // 分配内核栈，返回内核栈低地址
+    res->kstack = (usize)alloc(KERNEL_STACK_SIZE);
+    goto_trap_restore(&res->process_cx, res->kstack + KERNEL_STACK_SIZE);
+    res->parent = NULL;
+    INIT_LIST_HEAD(&res->list);
+    INIT_LIST_HEAD(&res->children);
+    INIT_LIST_HEAD(&res->sibling);
+    init_wait_queue(&res->wait_child);
+    res->ipc_state = IpcNone;
+    res->ipc_partner = NULL;
+    INIT_LIST_HEAD(&res->ipc_waiters);
+    INIT_LIST_HEAD(&res->ipc_link);
+    return res;
+}
+
+/**
+ * 回收已退出的进程（线程）
+ */
+void free_process(struct ProcessControlBlock *process) {
+    list_del(&process->sibling);
+    list_del(&process->pid_link);
+    dealloc_pid(process->pid);
+    sysstat_free(process);
+    put_file_table(process->files);
+    dealloc_ustack(process);
+    dealloc((void *)process->kstack, KERNEL_STACK_SIZE);
+    mm_put(process->mm);
+    dealloc((void *)process, sizeof(struct ProcessControlBlock));
+}
+
+/**
+ * 创建新进程
+ */
+struct ProcessControlBlock *new_process(char *elf, struct FileTable *files) {
+    struct ProcessControlBlock *res = alloc_process();
 
     // 设置根页表地址
     struct MemoryMap *mm = from_elf(elf);
     res->process_cx.satp = __satp(mm->root_ppn);
     res->mm = mm;
-    // 分配内核栈，返回内核栈低地址
-    res->kstack = (usize)alloc(KERNEL_STACK_SIZE);
+    vdso_set_pid(mm, res->tgid);
     // 分配映射用户栈
-    res->ustack = (usize)alloc(USER_STACK_SIZE);
-    // 将用户栈映射到固定位置
-    map_pages(mm->root_ppn, USER_STACK, __pa(res->ustack), USER_STACK_SIZE,
-              PAGE_VALID | PAGE_USER | PAGE_READ | PAGE_WRITE);
+    alloc_ustack(res, 0);
 
-    goto_trap_restore(&res->process_cx, res->kstack + KERNEL_STACK_SIZE);
     goto_app(&res->trap_cx, ((struct ElfHeader *)elf)->e_entry,
-             USER_STACK + USER_STACK_SIZE, res->kstack + KERNEL_STACK_SIZE);
-
-    INIT_LIST_HEAD(&res->list);
-    INIT_LIST_HEAD(&res->children);
-    INIT_LIST_HEAD(&res->sibling);
+             ustack_top(res), res->kstack + KERNEL_STACK_SIZE);
 
-    // stdin, stdout, stderr
-    for (int i = 0; i < 3; ++i) {
-        struct File *stdio = (struct File *)alloc(sizeof(struct File));
-        stdio->type = FILE_STDIO;
-        stdio->count = 1;
-        stdio->inode = NULL;
-        res->files[i] = stdio;
-    }
-    for (int i = 3; i < NR_OPEN; ++i) {
-        res->files[i] = NULL;
-    }
+    res->files = files;
+    ++nr_process;
     return res;
 }
 
@@ -137,195 +278,735 @@ struct ProcessControlBlock *new_process(char *elf) {
  * 添加进程到调度队列队尾中
  */
 void add_process(struct ProcessControlBlock *process) {
-    list_add_tail(&process->list, &idle->list);
+    list_add_tail(&process->list, &run_queue[process->prio]);
+    // 唤醒了优先级更高的进程，尽快让出 CPU
+    if (process->prio < current->prio) {
+        need_resched = 1;
+    }
+    // 当前进程可能在独占 CPU，没有设置时间片时钟
+    if (process != current) {
+        program_timer();
+    }
+}
+
+/**
+ * 记录进程从被唤醒到开始运行的延迟
+ */
+void account_wakeup(struct ProcessControlBlock *process) {
+    if (!process->wake_time) {
+        return;
+    }
+    usize latency = r_time() - process->wake_time;
+    process->wake_time = 0;
+    ++wakeup_latency.count;
+    wakeup_latency.total += latency;
+    if (latency > wakeup_latency.max) {
+        wakeup_latency.max = latency;
+    }
+}
+
+/**
+ * 是否有等待运行的进程
+ */
+int runnable() {
+    for (int i = 0; i < NR_PRIO; ++i) {
+        if (!list_empty(&run_queue[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 从优先级最高的非空调度队列中取出下一个要运行的进程
+ *
+ * @return 没有可运行的进程时返回 idle
+ */
+static struct ProcessControlBlock *pick_next() {
+    for (int i = 0; i < NR_PRIO; ++i) {
+        if (!list_empty(&run_queue[i])) {
+            struct ProcessControlBlock *next = list_entry(
+                run_queue[i].next, struct ProcessControlBlock, list);
+            list_del(&next->list);
+            return next;
+        }
+    }
+    return idle;
+}
+
+/**
+ * 从当前进程直接切换到 `next`，调用者需要先设置当前进程的状态
+ */
+static void switch_to(struct ProcessControlBlock *next) {
+    struct ProcessControlBlock *prev = current;
+    // 切换发生在内核态
+    account_cpu(0);
+    next->state = Running;
+    current = next;
+    account_wakeup(next);
+    start_slice();
+    if (next != prev) {
+        __switch(&prev->process_cx, &next->process_cx);
+    }
+}
+
+/**
+ * 初始化等待队列
+ */
+void init_wait_queue(struct WaitQueue *wq) { INIT_LIST_HEAD(&wq->head); }
+
+/**
+ * 唤醒被阻塞的进程，将其重新加入调度队列
+ */
+void wake_process(struct ProcessControlBlock *process) {
+    if (process->state == Blocked) {
+        process->state = Ready;
+        process->wake_time = r_time();
+        add_process(process);
+    }
+}
+
+/**
+ * 阻塞当前进程，直接切换到被阻塞的 `next`，不经过调度队列
+ *
+ * `next` 沿用当前进程剩余的时间片
+ */
+void handoff(struct ProcessControlBlock *next) {
+    struct ProcessControlBlock *prev = current;
+    prev->state = Blocked;
+    account_cpu(0);
+    next->state = Running;
+    next->wake_time = 0;
+    current = next;
+    __switch(&prev->process_cx, &next->process_cx);
+}
+
+/**
+ * 阻塞当前进程，直到被 wake_process() 唤醒
+ *
+ * 阻塞的进程不在调度队列中，不会再被调度
+ */
+void block_current() {
+    current->state = Blocked;
+    switch_to(pick_next());
+}
+
+/**
+ * 在等待队列上睡眠
+ *
+ * @note 被唤醒不代表等待的条件已经满足，调用者需要循环检查
+ */
+void sleep_on(struct WaitQueue *wq) {
+    struct WaitEntry entry;
+    entry.process = current;
+    list_add_tail(&entry.list, &wq->head);
+    block_current();
+    // 若由其他途径唤醒，等待项可能仍在队列中
+    list_del(&entry.list);
+}
+
+/**
+ * 唤醒等待队列上的所有进程
+ */
+void wakeup(struct WaitQueue *wq) {
+    while (!list_empty(&wq->head)) {
+        struct WaitEntry *entry =
+            list_entry(wq->head.next, struct WaitEntry, list);
+        list_del(&entry->list);
+        wake_process(entry->process);
+    }
 }
 
 /**
  * 进程调度
+ *
+ * 进程之间直接切换，只有没有可运行的进程时才会回到 idle
  */
 void schedule() {
-    while (!list_empty(&idle->list)) {
-        struct ProcessControlBlock *process;
-        list_for_each_entry(process, &idle->list, list) {
-            if (process->state == Ready) {
-                list_del(&process->list);
-                process->state = Running;
-                idle->state = Ready;
-                current = process;
-                __switch(&idle->process_cx, &current->process_cx);
-                current = idle;
-                idle->state = Running;
-                break;
-            }
+    while (nr_process) {
+        if (!runnable()) {
+            // 没有可运行的进程，只为真正的截止时间设置时钟，
+            // 然后让 CPU 停下来等待中断
+            program_timer();
+            wfi();
+            // 打开中断，在中断处理中执行到期的定时器
+            preempt_enable();
+            preempt_disable();
+            continue;
         }
+        idle->state = Ready;
+        switch_to(pick_next());
+    }
+}
+
+/**
+ * 进入不可抢占区域
+ *
+ * 内核默认不可抢占，只在不访问共享数据的长循环中打开抢占窗口
+ */
+void preempt_disable() {
+    w_sstatus(r_sstatus() & ~SSTATUS_SIE);
+    ++current->preempt_count;
+}
+
+/**
+ * 离开不可抢占区域，嵌套计数为 0 时打开中断
+ */
+void preempt_enable() {
+    if (!--current->preempt_count) {
+        w_sstatus(r_sstatus() | SSTATUS_SIE);
     }
 }
 
 /**
  * 挂起当前进程，重新调度
+ *
+ * 没有其他可运行的进程时直接开始新的时间片
  */
 void yield() {
+    if (!runnable()) {
+        start_slice();
+        return;
+    }
     current->state = Ready;
     add_process(current);
-    __switch(&current->process_cx, &idle->process_cx);
+    switch_to(pick_next());
+}
+
+/**
+ * 内核线程入口，执行线程函数
+ */
+static void kthread_start() {
+    current->kfn(current->kargs);
+    panic("Kernel thread %d returned!\n", current->pid);
+}
+
+/**
+ * 创建内核线程
+ *
+ * 内核线程没有用户地址空间，只在自己的内核栈上运行内核函数，
+ * 切换到内核线程时沿用当前页表。内核线程不计入用户进程数
+ *
+ * @param fn 线程函数，不能返回
+ * @param prio 调度优先级
+ * @param name 线程名
+ */
+struct ProcessControlBlock *kthread_create(void (*fn)(void *), void *args,
+                                           int prio, char *name) {
+    struct ProcessControlBlock *thread = alloc_process();
+    set_name(thread, name);
+    thread->prio = prio;
+    thread->mm = NULL;
+    thread->files = NULL;
+    thread->kfn = fn;
+    thread->kargs = args;
+    thread->process_cx.ra = (usize)kthread_start;
+    thread->process_cx.satp = 0;
+    add_process(thread);
+    return thread;
 }
 
 int sys_fork() {
-    struct ProcessControlBlock *child =
-        (struct ProcessControlBlock *)alloc(sizeof(struct ProcessControlBlock));
-    child->pid = alloc_pid();
-    child->state = Ready;
-    child->kstack = (usize)alloc(KERNEL_STACK_SIZE);
-    child->ustack = (usize)alloc(USER_STACK_SIZE);
+    struct ProcessControlBlock *child = alloc_process();
+    set_name(child, current->name);
     child->parent = current;
-    INIT_LIST_HEAD(&child->list);
-    INIT_LIST_HEAD(&child->children);
-    INIT_LIST_HEAD(&child->sibling);
+    child->traced = current->traced;
 
-    usize kernel_sp = child->kstack + KERNEL_STACK_SIZE;
-    goto_trap_restore(&child->process_cx, kernel_sp);
     // 复制地址空间
     child->mm = copy_mm(current->mm);
     child->process_cx.satp = __satp(child->mm->root_ppn);
-    // 将用户栈映射到固定位置
-    map_pages(child->mm->root_ppn, USER_STACK, __pa(child->ustack),
-              USER_STACK_SIZE, PAGE_VALID | PAGE_USER | PAGE_READ | PAGE_WRITE);
+    vdso_set_pid(child->mm, child->tgid);
+    // 只复制调用 fork 的线程，用户栈映射在相同的位置
+    alloc_ustack(child, current->stack_slot);
     // 复制用户栈（用户栈虚拟及物理地址均连续）
     char *src_stack = (char *)current->ustack;
     char *dst_stack = (char *)child->ustack;
+    preempt_enable();
     for (int i = 0; i < USER_STACK_SIZE; ++i) {
         dst_stack[i] = src_stack[i];
     }
+    preempt_disable();
     // 复制 Trap 上下文
+    usize kernel_sp = child->kstack + KERNEL_STACK_SIZE;
     child->trap_cx = current->trap_cx;
     child->trap_cx.kernel_sp = kernel_sp;
     // 子进程返回 0
     child->trap_cx.x[10] = 0;
+    // 复制浮点寄存器，子进程第一次使用时再恢复
+    fpu_flush();
+    child->fpu_cx = current->fpu_cx;
+    child->trap_cx.sstatus &= ~SSTATUS_FS;
 
     // 复制打开文件表
-    for (int i = 0; i < NR_OPEN; ++i) {
-        child->files[i] = current->files[i];
-        if (child->files[i]) {
-            ++(child->files[i]->count);
-        }
-    }
+    child->files = copy_file_table(current->files);
+    ++nr_process;
 
     list_add(&child->sibling, &current->children);
     add_process(child);
     return child->pid;
 }
 
-int sys_wait() {
-    int flag = 0;
-    int pid = -1;
+/**
+ * 创建与当前进程共享地址空间和打开文件表的线程
+ *
+ * 线程从 `entry` 开始执行，a0、a1 分别为 `arg0`、`arg1`，
+ * 使用地址空间中独立的用户栈。线程是当前线程的子进程，可以被 join 回收。
+ *
+ * @return 线程的 tid，-1 表示没有空闲的用户栈
+ */
+int sys_clone(usize entry, usize arg0, usize arg1) {
+    if (current->mm->stack_slots == -1UL) {
+        return -1;
+    }
+    struct ProcessControlBlock *thread = alloc_process();
+    set_name(thread, current->name);
+    thread->tgid = current->tgid;
+    thread->parent = current;
+    thread->traced = current->traced;
+
+    thread->mm = mm_get(current->mm);
+    thread->process_cx.satp = current->process_cx.satp;
+    alloc_ustack(thread, -1);
+    goto_app(&thread->trap_cx, entry, ustack_top(thread),
+             thread->kstack + KERNEL_STACK_SIZE);
+    thread->trap_cx.x[10] = arg0;
+    thread->trap_cx.x[11] = arg1;
+
+    thread->files = current->files;
+    ++thread->files->count;
+    ++nr_process;
+
+    list_add(&thread->sibling, &current->children);
+    add_process(thread);
+    return thread->pid;
+}
+
+/**
+ * 是否为当前进程自己创建的线程，wait 不回收这些线程
+ */
+static inline int own_thread(struct ProcessControlBlock *child) {
+    return child->pid != child->tgid && child->tgid == current->tgid;
+}
+
+/**
+ * 等待子进程退出并回收
+ *
+ * @param pid 等待的子进程（线程），-1 表示任意子进程，但不包括自己创建的线程
+ * @return 退出的子进程 pid，-1 表示没有可等待的子进程
+ */
+int sys_waitpid(int pid) {
     struct ProcessControlBlock *child;
+    if (pid != -1) { // 通过 pid 散列表直接找到子进程
+        while (1) {
+            // 睡眠期间子进程可能被过继并回收，每次唤醒后重新查找
+            child = find_process(pid);
+            if (!child || child->parent != current) {
+                return -1;
+            }
+            if (child->state == Exited) {
+                free_process(child);
+                return pid;
+            }
+            if (current->killed) {
+                return -1;
+            }
+            sleep_on(&current->wait_child);
+        }
+    }
     while (1) {
+        int flag = 0;
         list_for_each_entry(child, &current->children, sibling) {
-            if (child->state == Exited) { // 将子进程删除
-                list_del(&child->sibling);
-                // 回收进程资源
+            if (own_thread(child)) {
+                continue;
+            }
+            if (child->state == Exited) { // 将子进程删除并回收资源
                 pid = child->pid;
-                dealloc_pid(child->pid);
-                dealloc_files(child->files);
-                dealloc((void *)child->ustack, USER_STACK_SIZE);
-                dealloc((void *)child->kstack, KERNEL_STACK_SIZE);
-                dealloc_memory_map(child->mm);
-                dealloc((void *)child, sizeof(struct ProcessControlBlock));
+                free_process(child);
                 return pid;
             } else {
                 flag = 1;
             }
         }
-        if (flag) { // 有子进程还没退出，挂起当前进程等待
-            yield();
-        } else { // 所有子进程均退出，返回 -1
+        if (!flag || current->killed) { // 所有子进程均退出，返回 -1
             break;
         }
+        // 有子进程还没退出，阻塞直到有子进程退出
+        sleep_on(&current->wait_child);
     }
     return -1;
 }
 
+int sys_wait() { return sys_waitpid(-1); }
+
+/**
+ * 等待当前线程创建的线程 `tid` 退出并回收
+ *
+ * @return -1 表示 `tid` 不是当前线程创建的
+ */
+int sys_join(int tid) {
+    struct ProcessControlBlock *child = tid == -1 ? NULL : find_process(tid);
+    if (!child || child->parent != current || !own_thread(child)) {
+        return -1;
+    }
+    return sys_waitpid(tid);
+}
+
+/**
+ * 终止进程，进程在下一次返回用户态时退出
+ *
+ * 被阻塞的进程会被唤醒，阻塞的系统调用返回 -1
+ */
+int sys_kill(int pid) {
+    struct ProcessControlBlock *process = find_process(pid);
+    // 内核线程不能被终止
+    if (!process || process == init || !process->mm ||
+        process->state == Exited) {
+        return -1;
+    }
+    process->killed = 1;
+    wake_process(process);
+    return 0;
+}
+
+/**
+ * 检查 spawn 的参数和文件描述符重映射是否合法
+ */
+static int check_spawn(char **argv, struct SpawnAction *actions) {
+    int size = 0;
+    for (int i = 0; argv && argv[i]; ++i) {
+        if (i == MAX_ARGS) {
+            return -1;
+        }
+        for (char *c = argv[i]; *c; ++c) {
+            ++size;
+        }
+        ++size;
+    }
+    if (size > MAX_ARG_SIZE) {
+        return -1;
+    }
+    for (; actions && actions->fd != -1; ++actions) {
+        if (actions->fd < 0 || actions->fd >= NR_OPEN) {
+            return -1;
+        }
+        if (actions->src != -1 && !get_file(actions->src)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * 将参数复制到进程的用户栈上，作为 main(argc, argv) 的参数
+ *
+ * 栈顶依次为参数字符串和以 NULL 结尾的 argv 数组
+ */
+static void push_args(struct ProcessControlBlock *process, char **argv) {
+    // 用户栈在内核中的地址，与用户地址相差固定的偏移
+    usize top = process->ustack + USER_STACK_SIZE;
+    usize offset = ustack_top(process) - top;
+    usize uargv[MAX_ARGS + 1];
+    usize sp = top;
+    int argc = 0;
+    for (; argv && argv[argc]; ++argc) {
+        int len = 1;
+        for (char *c = argv[argc]; *c; ++c) {
+            ++len;
+        }
+        sp -= len;
+        for (int i = 0; i < len; ++i) {
+            ((char *)sp)[i] = argv[argc][i];
+        }
+        uargv[argc] = sp + offset;
+    }
+    uargv[argc] = 0;
+    // 栈指针按 16 字节对齐
+    sp = (sp - (argc + 1) * sizeof(usize)) & ~0xfUL;
+    for (int i = 0; i <= argc; ++i) {
+        ((usize *)sp)[i] = uargv[i];
+    }
+    process->trap_cx.x[2] = sp + offset;
+    process->trap_cx.x[10] = argc;
+    process->trap_cx.x[11] = sp + offset;
+}
+
+/**
+ * 直接从可执行文件创建子进程，不复制当前进程的地址空间
+ *
+ * 子进程继承当前进程的打开文件表，再依次执行 `actions` 中的重映射：
+ * 子进程的 fd 指向当前进程的 src，src 为 -1 表示关闭 fd
+ *
+ * @param argv 以 NULL 结尾的参数，可以为 NULL
+ * @param actions 以 fd 为 -1 的项结尾，可以为 NULL
+ * @return 子进程 pid，-1 表示文件不存在或参数不合法
+ */
+int sys_spawn(char *path, char **argv, struct SpawnAction *actions) {
+    struct Inode *inode = lookup(path);
+    if (!inode || check_spawn(argv, actions) == -1) {
+        return -1;
+    }
+    char *buf = (char *)alloc(inode->size);
+    readall(inode, buf);
+    struct ProcessControlBlock *child =
+        new_process(buf, copy_file_table(current->files));
+    dealloc(buf, inode->size);
+    set_name(child, path);
+    child->traced = current->traced;
+
+    push_args(child, argv);
+    for (; actions && actions->fd != -1; ++actions) {
+        struct File *file =
+            actions->src == -1 ? NULL : get_file(actions->src);
+        if (file) {
+            ++file->count;
+        }
+        install_fd(child->files, actions->fd, file);
+    }
+
+    child->parent = current;
+    list_add(&child->sibling, &current->children);
+    add_process(child);
+    return child->pid;
+}
+
+/**
+ * 终止与当前线程共享地址空间的其他线程，等待它们退出并回收
+ *
+ * 其他线程过继给当前线程以便回收。当前线程不是主线程时，
+ * 取代主线程成为其父进程的子进程。
+ *
+ * @return -1 表示等待期间当前线程被 kill
+ */
+static int kill_other_threads() {
+    struct MemoryMap *mm = current->mm;
+    struct ProcessControlBlock *process = find_process(current->tgid);
+    struct ProcessControlBlock *parent = NULL;
+    if (process && process != current && process->mm == mm &&
+        process->parent) {
+        parent = process->parent;
+        list_del(&current->sibling);
+        current->parent = parent;
+        list_add(&current->sibling, &parent->children);
+    }
+    for (int i = 0; i < PID_HASH_SIZE; ++i) {
+        list_for_each_entry(process, &pid_hash[i], pid_link) {
+            if (process == current || process->mm != mm) {
+                continue;
+            }
+            list_del(&process->sibling);
+            process->parent = current;
+            list_add(&process->sibling, &current->children);
+            if (process->state != Exited) {
+                process->killed = 1;
+                wake_process(process);
+            }
+        }
+    }
+    // 主线程已被过继，唤醒可能在 waitpid 中等待它的原父进程
+    if (parent) {
+        wakeup(&parent->wait_child);
+    }
+    while (1) {
+        int live = 0;
+        struct ProcessControlBlock *dead = NULL;
+        list_for_each_entry(process, &current->children, sibling) {
+            if (process->mm != mm) {
+                continue;
+            }
+            if (process->state == Exited) {
+                dead = process;
+                break;
+            }
+            live = 1;
+        }
+        if (dead) { // 回收后重新遍历
+            free_process(dead);
+            continue;
+        }
+        if (!live) {
+            return 0;
+        }
+        if (current->killed) {
+            return -1;
+        }
+        sleep_on(&current->wait_child);
+    }
+}
+
 int sys_exec(char *name) {
     struct Inode *inode = lookup(name);
-    if (!inode) {
+    if (!inode || kill_other_threads() == -1) {
         return -1;
     }
+    // name 在原地址空间中，替换地址空间前复制
+    set_name(current, name);
     char *buf = (char *)alloc(inode->size);
     readall(inode, buf);
     struct MemoryMap *mm = from_elf(buf);
 
+    // 释放原地址空间中的用户栈，内核栈使用原来的内核栈即可
+    dealloc_ustack(current);
     // 激活新页表
     activate_pagetable(mm->root_ppn);
-    // 替换进程地址空间
+    // 替换进程地址空间，其他线程均已回收，原地址空间随之释放
     struct MemoryMap *old_mm = current->mm;
     current->mm = mm;
-    dealloc_memory_map(old_mm);
+    mm_put(old_mm);
     current->process_cx.satp = __satp(mm->root_ppn);
+    // 成为新进程的主线程
+    current->tgid = current->pid;
+    vdso_set_pid(mm, current->tgid);
+    alloc_ustack(current, 0);
 
-    // 重新分配映射用户栈
-    // 内核栈使用原来的内核栈即可
-    dealloc((void *)current->ustack, USER_STACK_SIZE);
-    current->ustack = (usize)alloc(USER_STACK_SIZE);
-    // 将用户栈映射到固定位置
-    map_pages(mm->root_ppn, USER_STACK, __pa(current->ustack), USER_STACK_SIZE,
-              PAGE_VALID | PAGE_USER | PAGE_READ | PAGE_WRITE);
-
-    // 打开文件表取消共享
-    dealloc_files(current->files);
-    // stdin, stdout, stderr
-    for (int i = 0; i < 3; ++i) {
-        struct File *stdio = (struct File *)alloc(sizeof(struct File));
-        stdio->type = FILE_STDIO;
-        stdio->count = 1;
-        stdio->inode = NULL;
-        current->files[i] = stdio;
-    }
+    // 打开文件表取消共享，重新打开 stdin, stdout, stderr
+    put_file_table(current->files);
+    current->files = new_file_table();
 
     goto_app(&current->trap_cx, ((struct ElfHeader *)buf)->e_entry,
-             USER_STACK + USER_STACK_SIZE, current->kstack + KERNEL_STACK_SIZE);
+             ustack_top(current), current->kstack + KERNEL_STACK_SIZE);
+    fpu_release(current);
 
     dealloc(buf, inode->size);
     return 0;
 }
 
+static void fill_proc_info(struct ProcInfo *info,
+                           struct ProcessControlBlock *process) {
+    info->pid = process->pid;
+    info->tgid = process->tgid;
+    info->state = process->state;
+    info->prio = process->prio;
+    for (int i = 0; i < PROC_NAME_LEN; ++i) {
+        info->name[i] = process->name[i];
+    }
+    get_times(process, &info->times);
+}
+
+/**
+ * 获取系统中所有进程（包括内核线程和 idle）的信息
+ *
+ * @param max `buf` 最多能容纳的项数
+ * @return 填写的项数
+ */
+int sys_proc_list(struct ProcInfo *buf, int max) {
+    account_cpu(0);
+    if (max <= 0) {
+        return 0;
+    }
+    fill_proc_info(&buf[0], idle);
+    int n = 1;
+    for (int i = 0; i < PID_HASH_SIZE; ++i) {
+        struct ProcessControlBlock *process;
+        list_for_each_entry(process, &pid_hash[i], pid_link) {
+            if (n == max) {
+                return n;
+            }
+            fill_proc_info(&buf[n++], process);
+        }
+    }
+    return n;
+}
+
 /**
  * 终止当前进程运行
  */
 void exit_current() {
     current->state = Exited;
+    --nr_process;
+    del_timer(&current->timer);
+    fpu_release(current);
+    ipc_exit(current);
     // 进程调度的时候已经将其从调度队列移除，不用再次移除
     // 将进程的所有子进程挂到 init 进程上
-    if (current != init) {
+    if (current != init && !list_empty(&current->children)) {
         while (!list_empty(&current->children)) {
-            struct ProcessControlBlock *child;
-            list_for_each_entry(child, &current->children, sibling) {
-                list_del(&child->sibling);
-                list_add(&child->sibling, &init->children);
-            }
+            struct ProcessControlBlock *child = list_entry(
+                current->children.next, struct ProcessControlBlock, sibling);
+            list_del(&child->sibling);
+            child->parent = init;
+            list_add(&child->sibling, &init->children);
         }
+        // 过继的子进程可能已经退出
+        wakeup(&init->wait_child);
+    }
+    // 唤醒等待子进程退出的父进程
+    if (current->parent) {
+        wakeup(&current->parent->wait_child);
     }
-    __switch(&current->process_cx, &idle->process_cx);
+    switch_to(pick_next());
 }
 
 void init_process() {
+    for (int i = 0; i < PID_HASH_SIZE; ++i) {
+        INIT_LIST_HEAD(&pid_hash[i]);
+    }
+    for (int i = 0; i < NR_PRIO; ++i) {
+        INIT_LIST_HEAD(&run_queue[i]);
+    }
     idle =
         (struct ProcessControlBlock *)alloc(sizeof(struct ProcessControlBlock));
     idle->pid = alloc_pid();
+    set_name(idle, "idle");
+    idle->utime = idle->stime = idle->cycles = idle->instret = 0;
+    idle->sysstat = NULL;
+    idle->traced = 0;
+    idle->tgid = idle->pid;
     idle->state = Running;
+    // idle 不在调度队列中，优先级低于所有进程
+    idle->prio = NR_PRIO;
+    idle->killed = 0;
+    idle->preempt_count = 1;
+    idle->wake_time = 0;
+    idle->parent = NULL;
     INIT_LIST_HEAD(&idle->list);
+    INIT_LIST_HEAD(&idle->pid_link);
     INIT_LIST_HEAD(&idle->children);
     INIT_LIST_HEAD(&idle->sibling);
+    init_wait_queue(&idle->wait_child);
+    idle->ipc_state = IpcNone;
+    idle->ipc_partner = NULL;
+    INIT_LIST_HEAD(&idle->ipc_waiters);
+    INIT_LIST_HEAD(&idle->ipc_link);
+    INIT_LIST_HEAD(&idle->timer.list);
+    for (int i = 0; i < 32; ++i) {
+        idle->fpu_cx.f[i] = 0;
+    }
+    idle->fpu_cx.fcsr = 0;
+    // idle 使用启动时的栈，没有用户态和打开文件
+    idle->kstack = 0;
+    idle->ustack = 0;
+    idle->stack_slot = 0;
+    idle->files = NULL;
+    idle->kfn = NULL;
+    idle->kargs = NULL;
     // 重新映射内核
     idle->mm = remap_kernel();
+    // idle 只访问内核，沿用上一个进程的页表，避免切换时刷新 TLB
+    idle->process_cx.satp = 0;
+    current = idle;
 
     // 从文件系统中读取 elf 文件
     struct Inode *init_inode = lookup("init\0");
     char *buf = (char *)alloc(init_inode->size);
     readall(init_inode, buf);
-    init = new_process(buf);
+    // stdin, stdout, stderr
+    init = new_process(buf, new_file_table());
+    set_name(init, "init");
     add_process(init);
     dealloc(buf, init_inode->size);
 
+    init_kthreads();
+
     printf("***** Init Task *****\n");
     schedule();
+
+    if (wakeup_latency.count) {
+        printf("wakeup latency: %d wakeups, avg %d us, max %d us\n",
+               (int)wakeup_latency.count,
+               (int)(wakeup_latency.total / wakeup_latency.count * 1000000 /
+                     CLOCK_FREQ),
+               (int)(wakeup_latency.max * 1000000 / CLOCK_FREQ));
+    }
+    printf("max resched latency: %d us\n",
+           (int)(max_resched_latency * 1000000 / CLOCK_FREQ));
 }
\ No newline at end of file
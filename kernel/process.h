@@ -4,38 +4,117 @@
 #include "def.h"
 #include "list.h"
 #include "context.h"
-
-#define NR_OPEN 16
+#include "timer.h"
+#include "syscall.h"
 
 enum ProcState {
     Ready,
     Running,
+    // 阻塞在等待队列上，不在调度队列中
+    Blocked,
     Exited,
 };
 
+/**
+ * 同步 IPC 的状态
+ */
+enum IpcState {
+    IpcNone,
+    // 在对方的 ipc_waiters 上等待对方接收消息
+    IpcSending,
+    // 消息已被接收，在对方的 ipc_waiters 上等待回复
+    IpcCalling,
+    // 在 ipc_reply_wait 中等待消息
+    IpcReceiving,
+};
+
+/**
+ * 等待队列
+ */
+struct WaitQueue {
+    struct list_head head;
+};
+
+/**
+ * 等待队列项，由睡眠的进程在自己的内核栈上分配
+ */
+struct WaitEntry {
+    struct ProcessControlBlock *process;
+    struct list_head list;
+};
+
+// 调度优先级，数值越小优先级越高，同一优先级内轮转
+#define PRIO_HIGH 0
+#define PRIO_NORMAL 1
+#define PRIO_LOW 2
+#define NR_PRIO 3
+
 /**
  * 进程控制块
  */
 struct ProcessControlBlock {
     int pid;
+    char name[PROC_NAME_LEN];
+    // 线程组 id，即所属进程主线程的 pid
+    int tgid;
     enum ProcState state;
+    // 调度优先级
+    int prio;
+    // 已被 kill，返回用户态前退出
+    int killed;
+    // 为 0 时打开中断，允许在内核中被抢占
+    int preempt_count;
     // 进程与 Trap 上下文必须紧邻放置，在进程切换时
     // 会使用到它们之间的关系
     struct ProcessContext process_cx;
     struct TrapContext trap_cx;
     usize kstack;
     // ustack 保存用户栈在内核里的虚拟地址
-    // 在用户态时会被映射到固定的虚拟地址
+    // 在用户态时会被映射到地址空间中的一个栈槽
     usize ustack;
+    // 用户栈所在的栈槽，同一地址空间中的线程使用不同的栈槽
+    int stack_slot;
     struct MemoryMap *mm;
     struct ProcessControlBlock *parent;
     // 进程链表（调度队列）
     struct list_head list;
+    // pid 散列表链表
+    struct list_head pid_link;
     // 儿子节点链表
     struct list_head children;
     // 兄弟节点链表
     struct list_head sibling;
-    struct File *files[NR_OPEN];
+    // 等待子进程退出的等待队列
+    struct WaitQueue wait_child;
+    enum IpcState ipc_state;
+    // 发送消息或等待回复的对象，对方退出时置为 NULL
+    struct ProcessControlBlock *ipc_partner;
+    // 最近收到的消息的发送者
+    int ipc_from;
+    // 向该进程发送消息或等待其回复的进程
+    struct list_head ipc_waiters;
+    // ipc_waiters 链表
+    struct list_head ipc_link;
+    // 被唤醒的时间，用于统计唤醒延迟
+    usize wake_time;
+    // 用户态和内核态运行的时钟计数
+    usize utime;
+    usize stime;
+    // 运行期间的时钟周期数和指令数
+    usize cycles;
+    usize instret;
+    // 系统调用统计，开始统计前为 NULL
+    struct SyscallStats *sysstat;
+    // 是否跟踪系统调用，由 fork、clone 和 spawn 创建的进程继承
+    int traced;
+    // 睡眠定时器
+    struct Timer timer;
+    struct FileTable *files;
+    // 浮点寄存器，只在其他进程使用 FPU 时才保存
+    struct FpuContext fpu_cx;
+    // 内核线程执行的函数及其参数
+    void (*kfn)(void *);
+    void *kargs;
 };
 
 #endif
\ No newline at end of file
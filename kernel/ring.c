@@ -0,0 +1,139 @@
+#include "types.h"
+#include "def.h"
+#include "consts.h"
+#include "riscv.h"
+#include "mapping.h"
+#include "process.h"
+#include "syscall.h"
+#include "ring.h"
+
+extern struct ProcessControlBlock *current;
+
+/**
+ * 地址空间中的队列
+ */
+struct RingCtx {
+    // 队列的用户地址，只在该地址空间激活时访问
+    struct Ring *ring;
+    int flags;
+    // 轮询模式下到了处理队列的时间
+    int pending;
+    struct Timer timer;
+};
+
+static void ring_timeout(struct Timer *timer) {
+    container_of(timer, struct RingCtx, timer)->pending = 1;
+}
+
+static struct RingCtx *new_ring_ctx(int flags) {
+    struct RingCtx *ctx = (struct RingCtx *)alloc(sizeof(struct RingCtx));
+    ctx->ring = (struct Ring *)RING_BASE;
+    ctx->flags = flags;
+    ctx->pending = 0;
+    setup_timer(&ctx->timer, ring_timeout);
+    if (flags & RING_POLL) {
+        add_timer(&ctx->timer, r_time() + ns_to_ticks(RING_POLL_NS));
+    }
+    return ctx;
+}
+
+/**
+ * 复制地址空间时复制队列，队列所在的页已随地址空间复制
+ */
+struct RingCtx *ring_dup(struct RingCtx *ctx) {
+    return ctx ? new_ring_ctx(ctx->flags) : NULL;
+}
+
+/**
+ * 随地址空间释放队列
+ */
+void ring_free(struct RingCtx *ctx) {
+    if (ctx) {
+        del_timer(&ctx->timer);
+        dealloc((void *)ctx, sizeof(struct RingCtx));
+    }
+}
+
+static int ring_op_allowed(int op) {
+    return op == SYS_read || op == SYS_write || op == SYS_open ||
+           op == SYS_close;
+}
+
+/**
+ * 处理提交队列中至多 `n` 个请求，完成队列满或进程被 kill 时停止
+ *
+ * @return 处理的请求数
+ */
+static int ring_drain(struct Ring *ring, int n) {
+    int done = 0;
+    while (done < n && ring->sq_head != ring->sq_tail &&
+           ring->cq_tail - ring->cq_head < RING_ENTRIES && !current->killed) {
+        // 队列项可能被用户程序的其他线程同时修改，只读取一次，
+        // 之后只检查和使用内核中的副本
+        volatile struct RingSqe *src = &ring->sq[ring->sq_head & RING_MASK];
+        struct RingSqe sqe;
+        sqe.user_data = src->user_data;
+        sqe.op = src->op;
+        for (int i = 0; i < 3; ++i) {
+            sqe.args[i] = src->args[i];
+        }
+        struct RingCqe *cqe = &ring->cq[ring->cq_tail & RING_MASK];
+        cqe->user_data = sqe.user_data;
+        if (ring_op_allowed(sqe.op)) {
+            cqe->res = syscall(sqe.op, sqe.args[0], sqe.args[1], sqe.args[2]);
+        } else {
+            cqe->res = -ENOSYS;
+        }
+        ++ring->sq_head;
+        ++ring->cq_tail;
+        ++done;
+    }
+    return done;
+}
+
+/**
+ * 在当前地址空间中建立队列
+ *
+ * @param flags RING_POLL 表示轮询模式
+ * @return 队列的地址，-1 表示已经建立过
+ */
+usize sys_ring_setup(int flags) {
+    struct MemoryMap *mm = current->mm;
+    if (mm->ring) {
+        return -1;
+    }
+    struct Segment *segment =
+        new_segment(RING_BASE, RING_BASE + PAGE_SIZE,
+                    PAGE_VALID | PAGE_USER | PAGE_READ | PAGE_WRITE, Framed);
+    // 新分配的页帧已清零，队列为空
+    map_segment(mm->root_ppn, segment, NULL, 0);
+    list_add(&segment->list, &mm->segment_list);
+    mm->ring = new_ring_ctx(flags);
+    return RING_BASE;
+}
+
+/**
+ * 处理提交队列中至多 `to_submit` 个请求
+ *
+ * @return 处理的请求数，-1 表示没有建立队列
+ */
+int sys_ring_enter(int to_submit) {
+    struct RingCtx *ctx = current->mm->ring;
+    if (!ctx) {
+        return -1;
+    }
+    return ring_drain(ctx->ring, to_submit);
+}
+
+/**
+ * 返回用户态前处理轮询模式的队列
+ */
+void ring_poll() {
+    struct RingCtx *ctx = current->mm->ring;
+    if (!ctx || !ctx->pending) {
+        return;
+    }
+    ctx->pending = 0;
+    ring_drain(ctx->ring, RING_ENTRIES);
+    add_timer(&ctx->timer, r_time() + ns_to_ticks(RING_POLL_NS));
+}
@@ -0,0 +1,50 @@
+#ifndef _RING_H
+#define _RING_H
+
+#include "types.h"
+
+/**
+ * 批量系统调用的提交/完成队列，由进程和内核共享
+ *
+ * 用户程序在提交队列中填写请求并移动 sq_tail，内核处理请求后移动 sq_head，
+ * 并在完成队列中填写结果、移动 cq_tail，用户程序读取结果后移动 cq_head。
+ * 下标只增不减，取模得到队列中的位置
+ */
+
+// 队列映射到地址空间中的位置
+#define RING_BASE 0xffffffff00020000
+#define RING_ENTRIES 64
+#define RING_MASK (RING_ENTRIES - 1)
+
+// 轮询模式，内核在时钟中断后返回用户态时处理提交队列
+#define RING_POLL 1
+// 轮询间隔
+#define RING_POLL_NS 1000000
+
+/**
+ * 提交队列项，op 为系统调用号，目前支持 read、write、open、close
+ */
+struct RingSqe {
+    usize user_data;
+    int op;
+    usize args[3];
+};
+
+/**
+ * 完成队列项
+ */
+struct RingCqe {
+    usize user_data;
+    long res;
+};
+
+struct Ring {
+    volatile uint32 sq_head;
+    volatile uint32 sq_tail;
+    volatile uint32 cq_head;
+    volatile uint32 cq_tail;
+    struct RingSqe sq[RING_ENTRIES];
+    struct RingCqe cq[RING_ENTRIES];
+};
+
+#endif
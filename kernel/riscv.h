@@ -27,6 +27,12 @@ static inline void w_sie(usize x) { asm volatile("csrw sie, %0" : : "r"(x)); }
 #define SSTATUS_SPIE (1L << 5)
 #define SSTATUS_SPP (1L << 8)
 #define SSTATUS_SUM (1L << 18)
+// 浮点单元状态
+#define SSTATUS_FS (3L << 13)
+#define SSTATUS_FS_OFF (0L << 13)
+#define SSTATUS_FS_INITIAL (1L << 13)
+#define SSTATUS_FS_CLEAN (2L << 13)
+#define SSTATUS_FS_DIRTY (3L << 13)
 
 // 监管者模式状态寄存器
 static inline usize r_sstatus() {
@@ -39,6 +45,21 @@ static inline void w_sstatus(usize x) {
     asm volatile("csrw sstatus, %0" : : "r"(x));
 }
 
+#define SIP_STIP (1L << 5) // 时钟中断挂起
+// 监管者模式中断挂起寄存器
+static inline void w_sscratch(usize x) {
+    asm volatile("csrw sscratch, %0" : : "r"(x));
+}
+
+static inline usize r_sip() {
+    usize x;
+    asm volatile("csrr %0, sip" : "=r"(x));
+    return x;
+}
+
+// 等待中断，即使 sstatus.SIE 关闭，sie 中使能的中断挂起时也会返回
+static inline void wfi() { asm volatile("wfi"); }
+
 // 读取硬件时钟
 static inline usize r_time() {
     usize x;
@@ -46,6 +67,33 @@ static inline usize r_time() {
     return x;
 }
 
+// 读取时钟周期计数和已执行的指令数
+static inline usize r_cycle() {
+    usize x;
+    asm volatile("csrr %0, cycle" : "=r"(x));
+    return x;
+}
+
+static inline usize r_instret() {
+    usize x;
+    asm volatile("csrr %0, instret" : "=r"(x));
+    return x;
+}
+
+// 允许用户态读取的计数器
+#define SCOUNTEREN_CY (1L << 0)
+#define SCOUNTEREN_TM (1L << 1)
+#define SCOUNTEREN_IR (1L << 2)
+
+static inline void w_scounteren(usize x) {
+    asm volatile("csrw scounteren, %0" : : "r"(x));
+}
+
+// Sstc 扩展的监管者模式时钟比较寄存器
+static inline void w_stimecmp(usize x) {
+    asm volatile("csrw 0x14d, %0" : : "r"(x));
+}
+
 static inline usize r_satp() {
     usize x;
     asm volatile("csrr %0, satp" : "=r"(x));
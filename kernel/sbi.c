@@ -12,4 +12,44 @@ void shutdown() {
     }
 }
 
-void set_timer(usize time) { SBI_ECALL_1(SBI_SET_TIMER, time); }
\ No newline at end of file
+void set_timer(usize time) { SBI_ECALL_1(SBI_SET_TIMER, time); }
+
+/**
+ * SBI v0.2 调用，a7 为扩展号，a6 为功能号
+ */
+struct SbiRet sbi_call(usize eid, usize fid, usize arg0, usize arg1,
+                       usize arg2, usize arg3, usize arg4) {
+    register usize a0 asm("a0") = arg0;
+    register usize a1 asm("a1") = arg1;
+    register usize a2 asm("a2") = arg2;
+    register usize a3 asm("a3") = arg3;
+    register usize a4 asm("a4") = arg4;
+    register usize a6 asm("a6") = fid;
+    register usize a7 asm("a7") = eid;
+    asm volatile("ecall"
+                 : "+r"(a0), "+r"(a1)
+                 : "r"(a2), "r"(a3), "r"(a4), "r"(a6), "r"(a7)
+                 : "memory");
+    return (struct SbiRet){a0, a1};
+}
+
+/**
+ * 检查 SBI 实现是否支持扩展 `eid`
+ */
+int sbi_probe_extension(usize eid) {
+    struct SbiRet ret =
+        sbi_call(SBI_EXT_BASE, SBI_BASE_PROBE_EXTENSION, eid, 0, 0, 0, 0);
+    return !ret.error && ret.value;
+}
+
+/**
+ * 通过 SBI Debug Console 扩展输出一段数据
+ *
+ * @param pa 数据的物理地址
+ * @return 实际输出的字节数，-1 表示失败
+ */
+long sbi_console_write(usize pa, usize count) {
+    struct SbiRet ret =
+        sbi_call(SBI_EXT_DBCN, SBI_DBCN_CONSOLE_WRITE, count, pa, 0, 0, 0);
+    return ret.error ? -1 : ret.value;
+}
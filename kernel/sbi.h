@@ -12,6 +12,30 @@
 #define SBI_REMOTE_SFENCE_VMA_ASID 0x7
 #define SBI_SHUTDOWN 0x8
 
+// SBI v0.2 之后的扩展号
+#define SBI_EXT_BASE 0x10
+#define SBI_EXT_PMU 0x504D55
+#define SBI_EXT_DBCN 0x4442434E
+
+#define SBI_BASE_PROBE_EXTENSION 3
+
+#define SBI_DBCN_CONSOLE_WRITE 0
+
+#define SBI_PMU_COUNTER_CONFIG_MATCHING 2
+#define SBI_PMU_CFG_FLAG_CLEAR_VALUE (1 << 1)
+#define SBI_PMU_CFG_FLAG_AUTO_START (1 << 2)
+// 硬件事件编号
+#define SBI_PMU_HW_CPU_CYCLES 1
+#define SBI_PMU_HW_INSTRUCTIONS 2
+
+/**
+ * SBI v0.2 调用的返回值
+ */
+struct SbiRet {
+    long error;
+    long value;
+};
+
 #define SBI_ECALL(__num, __a0, __a1, __a2)                                     \
     ({                                                                         \
         register unsigned long a0 asm("a0") = (unsigned long)(__a0);           \
@@ -0,0 +1,173 @@
+#include "types.h"
+#include "def.h"
+#include "consts.h"
+#include "mapping.h"
+#include "process.h"
+#include "shm.h"
+
+extern struct ProcessControlBlock *current;
+
+// 所有仍有名字的共享内存对象
+static struct list_head shm_list;
+
+void init_shm() { INIT_LIST_HEAD(&shm_list); }
+
+static int name_equal(char *a, char *b) {
+    for (int i = 0; i < SHM_NAME_LEN; ++i) {
+        if (a[i] != b[i]) {
+            return 0;
+        }
+        if (!a[i]) {
+            return 1;
+        }
+    }
+    return 1;
+}
+
+static struct Shm *find_shm(char *name) {
+    struct Shm *shm;
+    list_for_each_entry(shm, &shm_list, list) {
+        if (name_equal(shm->name, name)) {
+            return shm;
+        }
+    }
+    return NULL;
+}
+
+struct Shm *shm_get(struct Shm *shm) {
+    ++shm->count;
+    return shm;
+}
+
+/**
+ * 释放共享内存对象的引用，最后一个引用释放时释放物理页
+ */
+void shm_put(struct Shm *shm) {
+    if (!--shm->count) {
+        dealloc((void *)__va(shm->ppn << 12), shm->size);
+        dealloc((void *)shm, sizeof(struct Shm));
+    }
+}
+
+/**
+ * 创建共享内存对象，内容初始为 0
+ *
+ * @param size 大小，向上取整到页
+ * @return -1 表示名字过长或已存在、大小不合法
+ */
+int sys_shm_create(char *name, usize size) {
+    int len = 0;
+    while (len < SHM_NAME_LEN && name[len]) {
+        ++len;
+    }
+    if (!len || len == SHM_NAME_LEN || !size || size > SHM_MAX_SIZE ||
+        find_shm(name)) {
+        return -1;
+    }
+    size = (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    struct Shm *shm = (struct Shm *)alloc(sizeof(struct Shm));
+    for (int i = 0; i <= len; ++i) {
+        shm->name[i] = name[i];
+    }
+    char *pages = (char *)alloc(size);
+    // 清零期间允许被抢占
+    preempt_enable();
+    for (usize i = 0; i < size; ++i) {
+        pages[i] = 0;
+    }
+    preempt_disable();
+    // 清零期间可能有其他进程创建了同名对象
+    if (find_shm(shm->name)) {
+        dealloc(pages, size);
+        dealloc((void *)shm, sizeof(struct Shm));
+        return -1;
+    }
+    shm->ppn = __pa((usize)pages) >> 12;
+    shm->size = size;
+    shm->count = 1;
+    list_add(&shm->list, &shm_list);
+    return 0;
+}
+
+/**
+ * 删除共享内存对象的名字，已有的映射仍然有效
+ */
+int sys_shm_unlink(char *name) {
+    struct Shm *shm = find_shm(name);
+    if (!shm) {
+        return -1;
+    }
+    list_del(&shm->list);
+    shm_put(shm);
+    return 0;
+}
+
+/**
+ * 在共享内存区中找一段未映射的地址，首次适配
+ *
+ * @return 0 表示没有足够大的空闲地址
+ */
+static usize find_shm_va(struct MemoryMap *mm, usize size) {
+    usize va = SHM_BASE;
+    while (va + size <= SHM_END) {
+        usize next = 0;
+        struct Segment *seg;
+        list_for_each_entry(seg, &mm->segment_list, list) {
+            if (seg->start_va < va + size && seg->end_va > va) {
+                next = seg->end_va;
+                break;
+            }
+        }
+        if (!next) {
+            return va;
+        }
+        va = next;
+    }
+    return 0;
+}
+
+/**
+ * 将共享内存对象映射到当前地址空间
+ *
+ * @return 映射的用户地址，-1 表示对象不存在或地址空间不足
+ */
+usize sys_shm_attach(char *name) {
+    struct Shm *shm = find_shm(name);
+    if (!shm) {
+        return -1;
+    }
+    struct MemoryMap *mm = current->mm;
+    usize va = find_shm_va(mm, shm->size);
+    if (!va) {
+        return -1;
+    }
+    struct Segment *segment =
+        new_segment(va, va + shm->size,
+                    PAGE_VALID | PAGE_USER | PAGE_READ | PAGE_WRITE, Shared);
+    segment->ppn = shm->ppn;
+    segment->shm = shm_get(shm);
+    map_segment(mm->root_ppn, segment, NULL, 0);
+    list_add_tail(&segment->list, &mm->segment_list);
+    return va;
+}
+
+/**
+ * 取消 `addr` 处共享内存的映射
+ *
+ * @return -1 表示 `addr` 不是共享内存的起始地址
+ */
+int sys_shm_detach(usize addr) {
+    struct MemoryMap *mm = current->mm;
+    struct Segment *seg;
+    list_for_each_entry(seg, &mm->segment_list, list) {
+        if (seg->shm && seg->start_va == addr) {
+            list_del(&seg->list);
+            unmap_pages(mm->root_ppn, seg->start_va,
+                        seg->end_va - seg->start_va);
+            shm_put(seg->shm);
+            dealloc((void *)seg, sizeof(struct Segment));
+            return 0;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,29 @@
+#ifndef _SHM_H
+#define _SHM_H
+
+#include "types.h"
+#include "list.h"
+
+#define SHM_NAME_LEN 16
+// 单个共享内存对象的最大大小
+#define SHM_MAX_SIZE (4 * 1024 * 1024)
+// 共享内存在用户地址空间中映射的范围
+#define SHM_BASE 0xffffffff00100000
+#define SHM_END 0xffffffff01000000
+
+/**
+ * 命名的共享内存对象，由一段连续的物理页组成
+ *
+ * 名字和每次映射各持有一个引用，最后一个引用释放时释放物理页
+ */
+struct Shm {
+    char name[SHM_NAME_LEN];
+    // 起始物理页号
+    usize ppn;
+    // 大小，按页对齐
+    usize size;
+    int count;
+    struct list_head list;
+};
+
+#endif
@@ -2,33 +2,84 @@
 #include "def.h"
 #include "syscall.h"
 #include "process.h"
+#include "riscv.h"
 
 extern struct ProcessControlBlock *current;
 
-usize syscall(usize id, usize args[3]) {
-    switch (id) {
-    case SYS_exit:
-        exit_current();
-    case SYS_putchar:
-        console_putchar(args[0]);
-        return 0;
-    case SYS_getpid:
-        return current->pid;
-    case SYS_fork:
-        return sys_fork();
-    case SYS_wait:
-        return sys_wait();
-    case SYS_exec:
-        return sys_exec((char *)args[0]);
-    case SYS_open:
-        return sys_open((char *)args[0], args[1]);
-    case SYS_close:
-        return sys_close(args[0]);
-    case SYS_read:
-        return sys_read(args[0], (char *)args[1], args[2]);
-    case SYS_write:
-        return sys_write(args[0], (char *)args[1], args[2]);
-    default:
-        panic("[syscall] Unknown syscall id %d\n", id);
+typedef usize (*SyscallFn)(usize, usize, usize);
+
+static usize sys_exit() {
+    exit_current();
+    return 0;
+}
+
+static usize sys_putchar(usize c) {
+    char ch = c;
+    console_write(&ch, 1);
+    return 0;
+}
+
+static usize sys_getpid() { return current->tgid; }
+
+static usize sys_gettid() { return current->pid; }
+
+/**
+ * 系统调用表，以系统调用号为下标
+ *
+ * 参数不足三个的系统调用忽略多余的参数
+ */
+static SyscallFn syscall_table[] = {
+    [SYS_exit] = (SyscallFn)sys_exit,
+    [SYS_putchar] = (SyscallFn)sys_putchar,
+    [SYS_getpid] = (SyscallFn)sys_getpid,
+    [SYS_fork] = (SyscallFn)sys_fork,
+    [SYS_wait] = (SyscallFn)sys_wait,
+    [SYS_exec] = (SyscallFn)sys_exec,
+    [SYS_open] = (SyscallFn)sys_open,
+    [SYS_close] = (SyscallFn)sys_close,
+    [SYS_read] = (SyscallFn)sys_read,
+    [SYS_write] = (SyscallFn)sys_write,
+    [SYS_nanosleep] = (SyscallFn)sys_nanosleep,
+    [SYS_sleep_until] = (SyscallFn)sys_sleep_until,
+    [SYS_gettime] = (SyscallFn)sys_gettime,
+    [SYS_clone] = (SyscallFn)sys_clone,
+    [SYS_join] = (SyscallFn)sys_join,
+    [SYS_gettid] = (SyscallFn)sys_gettid,
+    [SYS_futex] = (SyscallFn)sys_futex,
+    [SYS_waitpid] = (SyscallFn)sys_waitpid,
+    [SYS_kill] = (SyscallFn)sys_kill,
+    [SYS_spawn] = (SyscallFn)sys_spawn,
+    [SYS_times] = (SyscallFn)sys_times,
+    [SYS_proc_list] = (SyscallFn)sys_proc_list,
+    [SYS_ring_setup] = (SyscallFn)sys_ring_setup,
+    [SYS_ring_enter] = (SyscallFn)sys_ring_enter,
+    [SYS_pipe] = (SyscallFn)sys_pipe,
+    [SYS_dup2] = (SyscallFn)sys_dup2,
+    [SYS_shm_create] = (SyscallFn)sys_shm_create,
+    [SYS_shm_attach] = (SyscallFn)sys_shm_attach,
+    [SYS_shm_detach] = (SyscallFn)sys_shm_detach,
+    [SYS_shm_unlink] = (SyscallFn)sys_shm_unlink,
+    [SYS_ipc_call] = (SyscallFn)sys_ipc_call,
+    [SYS_ipc_reply_wait] = (SyscallFn)sys_ipc_reply_wait,
+    [SYS_poll] = (SyscallFn)sys_poll,
+    [SYS_sysstat] = (SyscallFn)sys_sysstat,
+    [SYS_trace_read] = (SyscallFn)sys_trace_read,
+    [SYS_dup] = (SyscallFn)sys_dup,
+};
+
+#define NR_SYSCALLS (sizeof(syscall_table) / sizeof(SyscallFn))
+
+/**
+ * 分发系统调用，并统计其耗时
+ *
+ * @return 系统调用号不存在时返回 -ENOSYS
+ */
+usize syscall(usize id, usize a0, usize a1, usize a2) {
+    if (id >= NR_SYSCALLS || !syscall_table[id]) {
+        return -ENOSYS;
     }
-}
\ No newline at end of file
+    usize start = r_cycle();
+    usize ret = syscall_table[id](a0, a1, a2);
+    sysstat_record(id, a0, a1, a2, ret, r_cycle() - start);
+    return ret;
+}
@@ -11,5 +11,99 @@
 #define SYS_close 7
 #define SYS_read 8
 #define SYS_write 9
+#define SYS_nanosleep 10
+#define SYS_sleep_until 11
+#define SYS_gettime 12
+#define SYS_clone 13
+#define SYS_join 14
+#define SYS_gettid 15
+#define SYS_futex 16
+#define SYS_waitpid 17
+#define SYS_kill 18
+#define SYS_spawn 19
+#define SYS_times 20
+#define SYS_proc_list 21
+#define SYS_ring_setup 22
+#define SYS_ring_enter 23
+#define SYS_pipe 24
+#define SYS_dup2 25
+#define SYS_shm_create 26
+#define SYS_shm_attach 27
+#define SYS_shm_detach 28
+#define SYS_shm_unlink 29
+#define SYS_ipc_call 30
+#define SYS_ipc_reply_wait 31
+#define SYS_poll 32
+#define SYS_sysstat 33
+#define SYS_trace_read 34
+#define SYS_dup 35
+
+// futex 操作
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+
+// poll 事件
+#define POLLIN 0x1
+#define POLLOUT 0x4
+// 管道的另一端已全部关闭
+#define POLLHUP 0x10
+// 文件描述符不合法
+#define POLLNVAL 0x20
+
+// 系统调用不存在
+#define ENOSYS 38
+
+// 同步 IPC 消息的字数，在 a1~a4 中传递
+#define IPC_MSG_WORDS 4
+
+// spawn 最多传递的参数个数及参数字符串的总长度
+#define MAX_ARGS 16
+#define MAX_ARG_SIZE 1024
+
+// 进程名的最大长度（包括结尾的 '\0'）
+#define PROC_NAME_LEN 16
+
+#ifndef __ASSEMBLER__
+#include "types.h"
+
+/**
+ * spawn 的文件描述符重映射，数组以 fd 为 -1 的项结尾
+ */
+struct SpawnAction {
+    int fd;  // 子进程中的文件描述符
+    int src; // 父进程中的文件描述符，-1 表示关闭 fd
+};
+
+/**
+ * poll 等待的文件描述符，fd 为负数的项被忽略
+ */
+struct PollFd {
+    int fd;
+    short events;  // 等待的事件
+    short revents; // 发生的事件
+};
+
+/**
+ * 进程（线程）使用的 CPU 资源
+ */
+struct ProcTimes {
+    usize utime;   // 用户态时间（纳秒）
+    usize stime;   // 内核态时间（纳秒）
+    usize cycles;  // 时钟周期数
+    usize instret; // 执行的指令数
+};
+
+/**
+ * proc_list 返回的进程信息
+ */
+struct ProcInfo {
+    int pid;
+    int tgid;
+    int state;
+    int prio;
+    char name[PROC_NAME_LEN];
+    struct ProcTimes times;
+};
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "types.h"
+#include "def.h"
+#include "bitops.h"
+#include "process.h"
+#include "sysstat.h"
+
+extern struct ProcessControlBlock *current;
+
+// 全系统的统计
+static struct SyscallStats global_stats;
+
+// 跟踪记录，满时覆盖最旧的记录
+static struct {
+    struct TraceRecord buf[TRACE_SIZE];
+    // 读写位置，只增不减，取模得到下标
+    usize r;
+    usize w;
+} trace;
+
+static void stats_reset(struct SyscallStats *stats) {
+    usize *p = (usize *)stats;
+    for (int i = 0; i < sizeof(struct SyscallStats) / sizeof(usize); ++i) {
+        p[i] = 0;
+    }
+}
+
+/**
+ * 按字复制，结构体较大，直接赋值会生成对 memcpy 的调用
+ */
+static void copy_words(void *dst, void *src, usize size) {
+    for (int i = 0; i < size / sizeof(usize); ++i) {
+        ((usize *)dst)[i] = ((usize *)src)[i];
+    }
+}
+
+static void stats_add(struct SyscallStats *stats, usize id, usize cycles) {
+    struct SyscallStat *stat = &stats->calls[id];
+    int bucket = highest_bit(cycles | 1);
+    ++stat->count;
+    stat->cycles += cycles;
+    ++stat->hist[bucket < SYSSTAT_BUCKETS ? bucket : SYSSTAT_BUCKETS - 1];
+}
+
+/**
+ * 记录当前进程一次系统调用的耗时和结果
+ *
+ * @param cycles 从进入到返回的时钟周期数，包括阻塞的时间
+ */
+void sysstat_record(usize id, usize a0, usize a1, usize a2, usize ret,
+                    usize cycles) {
+    if (id >= SYSSTAT_NR) {
+        return;
+    }
+    stats_add(&global_stats, id, cycles);
+    if (current->sysstat) {
+        stats_add(current->sysstat, id, cycles);
+    }
+    if (current->traced) {
+        struct TraceRecord *record = &trace.buf[trace.w++ % TRACE_SIZE];
+        record->pid = current->pid;
+        record->id = id;
+        record->args[0] = a0;
+        record->args[1] = a1;
+        record->args[2] = a2;
+        record->ret = ret;
+        record->cycles = cycles;
+        if (trace.w - trace.r > TRACE_SIZE) {
+            trace.r = trace.w - TRACE_SIZE;
+        }
+    }
+}
+
+/**
+ * 释放进程的统计
+ */
+void sysstat_free(struct ProcessControlBlock *process) {
+    if (process->sysstat) {
+        dealloc((void *)process->sysstat, sizeof(struct SyscallStats));
+        process->sysstat = NULL;
+    }
+}
+
+/**
+ * 读取或设置系统调用统计
+ *
+ * @param op SYSSTAT_GET 等操作
+ * @param pid 进程号，SYSSTAT_GET 和 SYSSTAT_RESET 时 0 表示全系统
+ * @param buf SYSSTAT_GET 时存放统计
+ * @return -1 表示进程不存在或未开始统计
+ */
+int sys_sysstat(int op, int pid, struct SyscallStats *buf) {
+    struct ProcessControlBlock *process = NULL;
+    struct SyscallStats *stats = &global_stats;
+    if (pid) {
+        process = find_process(pid);
+        if (!process || process->state == Exited) {
+            return -1;
+        }
+        stats = process->sysstat;
+    }
+    switch (op) {
+    case SYSSTAT_GET:
+        if (!stats) {
+            return -1;
+        }
+        copy_words(buf, stats, sizeof(struct SyscallStats));
+        return 0;
+    case SYSSTAT_RESET:
+        if (!stats) {
+            return -1;
+        }
+        stats_reset(stats);
+        return 0;
+    case SYSSTAT_ENABLE:
+        if (!process) {
+            return -1;
+        }
+        if (!process->sysstat) {
+            process->sysstat =
+                (struct SyscallStats *)alloc(sizeof(struct SyscallStats));
+            stats_reset(process->sysstat);
+        }
+        return 0;
+    case SYSSTAT_TRACE:
+    case SYSSTAT_UNTRACE:
+        if (!process) {
+            return -1;
+        }
+        process->traced = op == SYSSTAT_TRACE;
+        return 0;
+    }
+    return -1;
+}
+
+/**
+ * 按时间顺序取出至多 `max` 条跟踪记录
+ *
+ * @return 取出的记录数
+ */
+int sys_trace_read(struct TraceRecord *buf, int max) {
+    int n = 0;
+    while (n < max && trace.r != trace.w) {
+        copy_words(&buf[n++], &trace.buf[trace.r++ % TRACE_SIZE],
+                   sizeof(struct TraceRecord));
+    }
+    return n;
+}
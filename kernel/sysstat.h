@@ -0,0 +1,50 @@
+#ifndef _SYSSTAT_H
+#define _SYSSTAT_H
+
+#include "types.h"
+
+/**
+ * 系统调用统计和跟踪，内核和用户程序共用
+ */
+
+// 统计的系统调用号上限
+#define SYSSTAT_NR 64
+// 延迟直方图的桶数，第 i 个桶为 [2^i, 2^(i+1)) 个时钟周期，最后一个桶不设上限
+#define SYSSTAT_BUCKETS 32
+// 跟踪记录环形缓冲区的大小
+#define TRACE_SIZE 256
+
+// sysstat 的操作
+// 读取统计，pid 为 0 表示全系统
+#define SYSSTAT_GET 0
+// 开始统计进程的系统调用
+#define SYSSTAT_ENABLE 1
+// 清空统计，pid 为 0 表示全系统
+#define SYSSTAT_RESET 2
+// 开始、停止跟踪进程的系统调用
+#define SYSSTAT_TRACE 3
+#define SYSSTAT_UNTRACE 4
+
+struct SyscallStat {
+    usize count;
+    // 总时钟周期数
+    usize cycles;
+    uint32 hist[SYSSTAT_BUCKETS];
+};
+
+struct SyscallStats {
+    struct SyscallStat calls[SYSSTAT_NR];
+};
+
+/**
+ * 一次系统调用的跟踪记录
+ */
+struct TraceRecord {
+    int pid;
+    int id;
+    usize args[3];
+    usize ret;
+    usize cycles;
+};
+
+#endif
@@ -1,19 +1,397 @@
 #include "types.h"
 #include "def.h"
+#include "consts.h"
 #include "riscv.h"
+#include "bitops.h"
+#include "timer.h"
+#include "process.h"
 
-static const usize CLOCK_FREQ = 10000000;
-// 每10ms触发一次时钟中断
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// 时间片长度为 10ms
 static const usize TICKS_PER_SEC = 100;
 
+/**
+ * 分层时间轮
+ *
+ * 共 WHEEL_LEVELS 层，每层 WHEEL_SIZE 个槽。第 0 层每个槽为 1 个 jiffy，
+ * 第 i 层每个槽为 WHEEL_SIZE^i 个 jiffy。高层的定时器在时间轮转过
+ * 对应的边界时下沉到低层，最终在第 0 层到期。
+ * 到期时间向上取整到 jiffy，相近的截止时间会合并为一次时钟中断。
+ */
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4
+// 时间轮能表示的最大时间跨度
+#define WHEEL_RANGE (1UL << (WHEEL_BITS * WHEEL_LEVELS))
+// 时间轮的粒度为 1ms
+#define JIFFY (CLOCK_FREQ / 1000)
+
+static struct list_head wheel[WHEEL_LEVELS][WHEEL_SIZE];
+// 每层非空槽的位图
+static usize pending[WHEEL_LEVELS];
+// 时间轮下一个要处理的 jiffy
+static usize wheel_clk;
+
+extern struct ProcessControlBlock *current, *idle;
+
+// 系统启动时的时钟计数
+usize boot_time;
+// 当前时间片结束的时间
+static usize slice_end = 0;
+static struct Timer slice_timer;
+// 是否支持 Sstc 扩展，支持时直接写 stimecmp 设置时钟，不再陷入 M 态
+int has_sstc = 0;
+// 已经设置给硬件的时钟中断时间，-1 表示未设置
+static usize next_timeout = -1;
+// 当前进程的时间片已用完，需要重新调度
+int need_resched = 0;
+// 时间片到期的时间，用于统计到期后多久才真正切换
+static usize resched_time = 0;
+// 时间片到期到切换的最大延迟
+usize max_resched_latency = 0;
+
+/**
+ * 时间片到期
+ */
+static void slice_expired(struct Timer *timer) {
+    need_resched = 1;
+    resched_time = r_time();
+}
+
+/**
+ * 启动时根据设备树检测 Sstc 扩展
+ *
+ * @param dtb 设备树物理地址
+ */
+void probe_timer(usize dtb) { has_sstc = dtb_has_isa_extension(dtb, "sstc"); }
+
+/**
+ * 设置硬件时钟比较值，-1 表示关闭时钟
+ */
+void set_deadline(usize deadline) {
+    if (has_sstc) {
+        w_stimecmp(deadline);
+    } else {
+        set_timer(deadline);
+    }
+}
+
 void init_timer() {
-    // 时钟中断使能
+    for (int i = 0; i < WHEEL_LEVELS; ++i) {
+        for (int j = 0; j < WHEEL_SIZE; ++j) {
+            INIT_LIST_HEAD(&wheel[i][j]);
+        }
+        pending[i] = 0;
+    }
+    boot_time = r_time();
+    wheel_clk = boot_time / JIFFY;
+    setup_timer(&slice_timer, slice_expired);
+    // 时钟中断使能，只在有截止时间时才设置时钟
     w_sie(r_sie() | SIE_STIE);
-    // 设置第一次时钟中断
-    set_next_timeout();
+    printf("***** Init Timer (%s) *****\n", has_sstc ? "stimecmp" : "SBI");
+}
+
+/**
+ * 初始化定时器
+ */
+void setup_timer(struct Timer *timer, void (*func)(struct Timer *)) {
+    timer->func = func;
+    INIT_LIST_HEAD(&timer->list);
+}
+
+/**
+ * 将定时器放入时间轮中合适的层和槽
+ */
+static void enqueue_timer(struct Timer *timer) {
+    usize expires = (timer->expires + JIFFY - 1) / JIFFY;
+    if (expires < wheel_clk) { // 已经过期，下一次处理时到期
+        expires = wheel_clk;
+    }
+    usize delta = expires - wheel_clk;
+    if (delta >= WHEEL_RANGE) {
+        expires = wheel_clk + WHEEL_RANGE - 1;
+        delta = WHEEL_RANGE - 1;
+    }
+    int level = 0;
+    while (delta >= (1UL << (WHEEL_BITS * (level + 1)))) {
+        ++level;
+    }
+    int slot = (expires >> (WHEEL_BITS * level)) & WHEEL_MASK;
+    timer->level = level;
+    timer->slot = slot;
+    list_add_tail(&timer->list, &wheel[level][slot]);
+    pending[level] |= 1UL << slot;
+}
+
+/**
+ * 时间轮为空时直接拨到 `now`，避免长时间空闲后逐槽追赶
+ */
+static void forward_clk(usize now) {
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        if (pending[level]) {
+            return;
+        }
+    }
+    if (now / JIFFY > wheel_clk) {
+        wheel_clk = now / JIFFY;
+    }
+}
+
+/**
+ * 将定时器从时间轮中取出
+ */
+static void detach_timer(struct Timer *timer) {
+    list_del(&timer->list);
+    if (list_empty(&wheel[timer->level][timer->slot])) {
+        pending[timer->level] &= ~(1UL << timer->slot);
+    }
+}
+
+/**
+ * 添加定时器
+ *
+ * @param timer 已经初始化的定时器，若已添加则修改其到期时间
+ * @param expires 到期时间（硬件时钟计数）
+ */
+void add_timer(struct Timer *timer, usize expires) {
+    if (timer_pending(timer)) {
+        detach_timer(timer);
+    }
+    timer->expires = expires;
+    forward_clk(r_time());
+    enqueue_timer(timer);
+}
+
+/**
+ * 删除尚未到期的定时器
+ */
+void del_timer(struct Timer *timer) {
+    if (timer_pending(timer)) {
+        detach_timer(timer);
+    }
+}
+
+/**
+ * 将高层的一个槽中的定时器重新放入时间轮
+ */
+static void cascade(int level, int slot) {
+    struct list_head *head = &wheel[level][slot];
+    while (!list_empty(head)) {
+        struct Timer *timer = list_entry(head->next, struct Timer, list);
+        detach_timer(timer);
+        enqueue_timer(timer);
+    }
+}
+
+/**
+ * 处理所有在 `now` 之前到期的定时器
+ */
+static void run_timers(usize now) {
+    usize now_jiffy = now / JIFFY;
+    forward_clk(now);
+    while (wheel_clk <= now_jiffy) {
+        int slot = wheel_clk & WHEEL_MASK;
+        if (!slot) {
+            // 转过一圈，依次从高层下沉定时器
+            for (int level = 1; level < WHEEL_LEVELS; ++level) {
+                int index = (wheel_clk >> (WHEEL_BITS * level)) & WHEEL_MASK;
+                cascade(level, index);
+                if (index) {
+                    break;
+                }
+            }
+        } else if (!pending[0]) {
+            // 第 0 层为空，直接跳到下一个需要下沉的边界
+            usize boundary = (wheel_clk | WHEEL_MASK) + 1;
+            wheel_clk = MIN(boundary, now_jiffy + 1);
+            continue;
+        }
+        struct list_head *head = &wheel[0][slot];
+        while (!list_empty(head)) {
+            struct Timer *timer = list_entry(head->next, struct Timer, list);
+            detach_timer(timer);
+            timer->func(timer);
+        }
+        ++wheel_clk;
+    }
+}
+
+/**
+ * 最近一次需要处理时间轮的 jiffy
+ *
+ * 第 0 层给出精确的到期时间，高层给出下一次下沉的时间
+ *
+ * @return -1 表示没有定时器
+ */
+static usize next_expiry() {
+    usize next = -1;
+    if (pending[0]) {
+        int slot = wheel_clk & WHEEL_MASK;
+        next = wheel_clk + lowest_bit(rotate_right(pending[0], slot));
+    }
+    for (int level = 1; level < WHEEL_LEVELS; ++level) {
+        if (!pending[level]) {
+            continue;
+        }
+        int shift = WHEEL_BITS * level;
+        // wheel_clk 恰在边界上时当前槽尚未下沉，否则当前槽中的定时器
+        // 要等转完一圈
+        usize first = (wheel_clk >> shift) +
+                      ((wheel_clk & ((1UL << shift) - 1)) ? 1 : 0);
+        usize distance =
+            lowest_bit(rotate_right(pending[level], first & WHEEL_MASK));
+        next = MIN(next, (first + distance) << shift);
+    }
+    return next;
+}
+
+static int test_fired;
+
+static void test_timeout(struct Timer *timer) { test_fired = 1; }
+
+/**
+ * 检查高层定时器在下沉边界上能按时设置时钟
+ *
+ * 在空的时间轮上手动推进 wheel_clk，结束后恢复
+ */
+void test_timer() {
+    struct Timer timer;
+    usize saved = wheel_clk;
+    // 对齐到第 2 层的边界，之后只经过第 1 层的下沉
+    usize base = (wheel_clk | ((1UL << (WHEEL_BITS * 2)) - 1)) + 1;
+    printf("Timer wheel test\n");
+    setup_timer(&timer, test_timeout);
+    test_fired = 0;
+    wheel_clk = base + 250;
+    timer.expires = (base + 330) * JIFFY;
+    enqueue_timer(&timer);
+    if (timer.level != 1) {
+        panic("timer at level %d, expected 1\n", timer.level);
+    }
+    // 停在第 1 层的边界上，该槽尚未下沉
+    run_timers((base + 319) * JIFFY);
+    if (next_expiry() != base + 320) {
+        panic("next expiry %d jiffies after base, expected 320\n",
+              next_expiry() - base);
+    }
+    run_timers((base + 320) * JIFFY);
+    if (next_expiry() != base + 330) {
+        panic("next expiry %d jiffies after base, expected 330\n",
+              next_expiry() - base);
+    }
+    run_timers((base + 330) * JIFFY);
+    if (!test_fired || next_expiry() != -1) {
+        panic("timer did not fire on time\n");
+    }
+    wheel_clk = saved;
+    printf("Timer wheel test passed!\n");
+}
+
+/**
+ * 根据最近的截止时间设置下一次时钟中断
+ *
+ * 只在还有其他进程可运行时设置时间片结束时间，
+ * 没有任何定时器时不设置时钟中断
+ */
+void program_timer() {
+    if (current != idle && runnable()) {
+        if (!timer_pending(&slice_timer)) {
+            add_timer(&slice_timer, slice_end);
+        }
+    } else {
+        del_timer(&slice_timer);
+    }
+    usize next = next_expiry();
+    usize deadline = next == -1 ? -1 : next * JIFFY;
+    if (deadline != next_timeout) {
+        set_deadline(deadline);
+        next_timeout = deadline;
+    }
+}
+
+/**
+ * 为即将运行的进程开始新的时间片
+ */
+void start_slice() {
+    if (resched_time) {
+        usize latency = r_time() - resched_time;
+        if (latency > max_resched_latency) {
+            max_resched_latency = latency;
+        }
+        resched_time = 0;
+    }
+    need_resched = 0;
+    slice_end = r_time() + CLOCK_FREQ / TICKS_PER_SEC;
+    del_timer(&slice_timer);
+    program_timer();
+}
+
+/**
+ * 处理时钟中断，执行到期的定时器
+ */
+void timer_tick() {
+    usize now = r_time();
+    // 强制重新设置时钟，清除已挂起的时钟中断
+    next_timeout = 0;
+    vdso_update_ticks(now);
+    run_timers(now);
+    program_timer();
+}
+
+/**
+ * 纳秒转换为时钟计数
+ */
+usize ns_to_ticks(usize ns) {
+    return ns / 1000 * (CLOCK_FREQ / 1000000) +
+           ns % 1000 * (CLOCK_FREQ / 1000000) / 1000;
+}
+
+/**
+ * 时钟计数转换为纳秒
+ */
+usize ticks_to_ns(usize ticks) {
+    return ticks / CLOCK_FREQ * 1000000000 +
+           ticks % CLOCK_FREQ * 1000 / (CLOCK_FREQ / 1000000);
+}
+
+/**
+ * 睡眠定时器到期，唤醒进程
+ */
+static void sleep_timeout(struct Timer *timer) {
+    wake_process(container_of(timer, struct ProcessControlBlock, timer));
+}
+
+/**
+ * 阻塞当前进程直到时钟计数 `deadline`
+ */
+void sleep_until_ticks(usize deadline) {
+    setup_timer(&current->timer, sleep_timeout);
+    add_timer(&current->timer, deadline);
+    while (timer_pending(&current->timer)) {
+        if (current->killed) {
+            del_timer(&current->timer);
+            break;
+        }
+        block_current();
+    }
+}
+
+int sys_nanosleep(usize ns) {
+    sleep_until_ticks(r_time() + ns_to_ticks(ns));
+    return 0;
+}
+
+/**
+ * 睡眠到系统启动后 `ns` 纳秒
+ */
+int sys_sleep_until(usize ns) {
+    sleep_until_ticks(boot_time + ns_to_ticks(ns));
+    return 0;
 }
 
 /**
- * 设置下一次时钟
+ * 获取系统启动以来的纳秒数
  */
-void set_next_timeout() { set_timer(r_time() + CLOCK_FREQ / TICKS_PER_SEC); }
\ No newline at end of file
+usize sys_gettime() { return ticks_to_ns(r_time() - boot_time); }
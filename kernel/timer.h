@@ -0,0 +1,28 @@
+#ifndef _TIMER_H
+#define _TIMER_H
+
+#include "types.h"
+#include "list.h"
+
+/**
+ * 内核定时器
+ */
+struct Timer {
+    // 到期时间（硬件时钟计数）
+    usize expires;
+    // 到期时在时钟中断中调用，不能阻塞
+    void (*func)(struct Timer *);
+    // 所在时间轮的层和槽
+    int level;
+    int slot;
+    struct list_head list;
+};
+
+/**
+ * 定时器是否已添加且尚未到期
+ */
+static inline int timer_pending(struct Timer *timer) {
+    return !list_empty(&timer->list);
+}
+
+#endif
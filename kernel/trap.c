@@ -6,10 +6,13 @@
 #include "process.h"
 
 extern struct ProcessControlBlock *current, *idle;
+extern int need_resched;
 
 void init_trap() {
     // 设置 stvec 寄存器，设置中断处理函数和处理模式
     w_stvec((usize)__trap_entry | MODE_DIRECT);
+    // 当前在内核态
+    w_sscratch(0);
     // 初始化时钟中断
     init_timer();
     printf("***** Init Trap *****\n");
@@ -23,26 +26,48 @@ void breakpoint(struct TrapContext *context) {
 
 void syscall_handle(struct TrapContext *context) {
     context->sepc += 4;
-    usize ret =
-        syscall(context->x[17],
-                (usize[]){context->x[10], context->x[11], context->x[12]});
+    usize ret = syscall(context->x[17], context->x[10], context->x[11],
+                        context->x[12]);
     // 可能调用 exec 系统调用导致上下文被替换
     context = &current->trap_cx;
     context->x[10] = ret;
 }
 
-void supervisor_timer() {
-    set_next_timeout();
-    yield();
-}
+void supervisor_timer() { timer_tick(); }
 
 void fault(struct TrapContext *context, usize scause, usize stval) {
     panic("Unhandled trap!\nscause\t= %p\nsepc\t= %p\nstval\t= %p\n", scause,
           context->sepc, stval);
 }
 
+/**
+ * 返回用户态前的检查
+ */
+static void prepare_return() {
+    // 检查是否需要重新调度
+    if (need_resched) {
+        yield();
+    }
+    // 轮询的请求可能阻塞，期间进程可能被 kill
+    ring_poll();
+    // 被 kill 的进程不再返回用户态
+    if (current->killed) {
+        exit_current();
+    }
+    // 空闲期间没有时钟中断，返回用户态时刷新低精度时钟
+    vdso_update_ticks(r_time());
+    account_cpu(0);
+}
+
 void trap_handle(struct TrapContext *context, usize scause, usize stval) {
+    account_cpu(1);
     switch (scause) {
+    case ILLEGAL_INSTRUCTION:
+        // 第一次使用浮点指令
+        if (fpu_trap(context) == -1) {
+            fault(context, scause, stval);
+        }
+        break;
     case BREAKPOINT:
         breakpoint(context);
         break;
@@ -52,11 +77,52 @@ void trap_handle(struct TrapContext *context, usize scause, usize stval) {
     case SUPERVISOR_TIMER:
         supervisor_timer();
         break;
+    case SUPERVISOR_EXTERNAL:
+        plic_handle();
+        break;
     default:
         fault(context, scause, stval);
         break;
     }
+    prepare_return();
     // 可能调用 exec 系统调用导致上下文被替换
     context = &current->trap_cx;
     __restore(context);
-}
\ No newline at end of file
+}
+
+/**
+ * 系统调用快速路径，Trap 上下文中只保存了调用者保存的寄存器
+ *
+ * @return 返回用户态时恢复的 Trap 上下文
+ */
+struct TrapContext *fast_syscall(struct TrapContext *context) {
+    account_cpu(1);
+    syscall_handle(context);
+    prepare_return();
+    return &current->trap_cx;
+}
+
+/**
+ * 处理内核态的 Trap
+ *
+ * 内核只在抢占窗口中打开中断，此时可以直接切换到其他进程
+ */
+void kernel_trap_handle(struct TrapContext *context, usize scause,
+                        usize stval) {
+    switch (scause) {
+    case SUPERVISOR_TIMER:
+        supervisor_timer();
+        // idle 不在调度队列中，不能被抢占
+        if (need_resched && current != idle) {
+            yield();
+        }
+        break;
+    case SUPERVISOR_EXTERNAL:
+        plic_handle();
+        break;
+    default:
+        panic("Unhandled kernel trap!\nscause\t= %p\nsepc\t= %p\nstval\t= "
+              "%p\n",
+              scause, context->sepc, stval);
+    }
+}
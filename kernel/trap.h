@@ -1,8 +1,10 @@
 #ifndef _TRAP_H
 #define _TRAP_H
 
+#define ILLEGAL_INSTRUCTION 2L
 #define BREAKPOINT 3L
 #define USER_ENV_CALL 8L
 #define SUPERVISOR_TIMER 5L | (1L << 63)
+#define SUPERVISOR_EXTERNAL 9L | (1L << 63)
 
 #endif
\ No newline at end of file
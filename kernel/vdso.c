@@ -0,0 +1,57 @@
+#include "types.h"
+#include "def.h"
+#include "consts.h"
+#include "riscv.h"
+#include "mapping.h"
+#include "vdso.h"
+
+extern usize boot_time;
+
+// 共享数据页的物理页号及其内核地址
+static usize vdso_ppn;
+static struct VdsoData *vdso_data = NULL;
+
+void init_vdso() {
+    vdso_ppn = alloc_frame();
+    vdso_data = (struct VdsoData *)__va(vdso_ppn << 12);
+    vdso_data->timebase = CLOCK_FREQ;
+    vdso_data->boot_time = boot_time;
+    vdso_data->ticks = boot_time;
+    // 允许用户态直接读取 cycle、time、instret
+    w_scounteren(SCOUNTEREN_CY | SCOUNTEREN_TM | SCOUNTEREN_IR);
+    printf("***** Init vDSO *****\n");
+}
+
+/**
+ * 将 vDSO 数据页映射到地址空间中
+ */
+void map_vdso(struct MemoryMap *mm) {
+    usize flags = PAGE_VALID | PAGE_USER | PAGE_READ;
+    struct Segment *data =
+        new_segment(VDSO_DATA, VDSO_DATA + PAGE_SIZE, flags, Shared);
+    data->ppn = vdso_ppn;
+    map_segment(mm->root_ppn, data, NULL, 0);
+    list_add(&data->list, &mm->segment_list);
+
+    struct Segment *proc =
+        new_segment(VDSO_PROC, VDSO_PROC + PAGE_SIZE, flags, Framed);
+    map_segment(mm->root_ppn, proc, NULL, 0);
+    list_add(&proc->list, &mm->segment_list);
+}
+
+/**
+ * 设置地址空间中 vDSO 私有页的 pid
+ */
+void vdso_set_pid(struct MemoryMap *mm, int pid) {
+    struct VdsoProc *proc = (struct VdsoProc *)__va(translate(mm, VDSO_PROC));
+    proc->pid = pid;
+}
+
+/**
+ * 时钟中断和返回用户态时更新低精度时钟
+ */
+void vdso_update_ticks(usize now) {
+    if (vdso_data) {
+        vdso_data->ticks = now;
+    }
+}
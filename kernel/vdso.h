@@ -0,0 +1,37 @@
+#ifndef _VDSO_H
+#define _VDSO_H
+
+#include "types.h"
+
+/**
+ * vDSO 数据页，映射到每个地址空间的固定位置，用户态只读
+ *
+ * 用户程序不经过系统调用即可读取时间和 pid
+ */
+
+// 所有进程共享的数据页
+#define VDSO_DATA 0xffffffff00010000
+// 每个地址空间私有的数据页
+#define VDSO_PROC (VDSO_DATA + 0x1000)
+
+#define CLOCK_MONOTONIC 1
+// 最近一次时钟中断或返回用户态的时间，精度较低。
+// 时钟中断只在有截止时间时才发生，独占 CPU 且不陷入内核的进程
+// 读到的值可能任意陈旧
+#define CLOCK_MONOTONIC_COARSE 6
+
+struct VdsoData {
+    // 时钟频率
+    usize timebase;
+    // 系统启动时的时钟计数
+    usize boot_time;
+    // 最近一次时钟中断或返回用户态时的时钟计数
+    volatile usize ticks;
+};
+
+struct VdsoProc {
+    // 进程的 pid（主线程的 tid）
+    int pid;
+};
+
+#endif
@@ -0,0 +1,423 @@
+#include "kernel/types.h"
+#include "kernel/consts.h"
+#include "kernel/fs.h"
+#include "kernel/string.h"
+#include "kernel/vdso.h"
+#include "kernel/ring.h"
+#include "ulib.h"
+
+/**
+ * 内核性能测试
+ *
+ * `bench` 运行全部测试，`bench <name>...` 只运行指定的测试
+ */
+
+#define ROUNDS 100
+
+/**
+ * 比较 fork+exec 与 spawn 创建进程的延迟
+ */
+void bench_spawn() {
+    usize start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        int pid = fork();
+        if (!pid) {
+            exec("true\0");
+            exit();
+        }
+        waitpid(pid);
+    }
+    usize fork_exec = (gettime() - start) / ROUNDS;
+
+    start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        waitpid(spawn("true\0", NULL, NULL));
+    }
+    usize spawn_ns = (gettime() - start) / ROUNDS;
+
+    printf("fork+exec: %d ns, spawn: %d ns\n", (int)fork_exec, (int)spawn_ns);
+}
+
+// 乒乓测试中轮到哪个线程运行，0 为主线程，1 为对端线程
+int turn;
+
+void ponger(void *arg) {
+    for (int i = 0; i < ROUNDS; ++i) {
+        while (turn != 1) {
+            futex(&turn, FUTEX_WAIT, 0);
+        }
+        turn = 0;
+        futex(&turn, FUTEX_WAKE, 1);
+    }
+}
+
+/**
+ * 两个线程通过 futex 交替运行，测量上下文切换的延迟
+ */
+void bench_pingpong() {
+    turn = 0;
+    int tid = thread_create(ponger, NULL);
+    usize start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        turn = 1;
+        futex(&turn, FUTEX_WAKE, 1);
+        while (turn != 0) {
+            futex(&turn, FUTEX_WAIT, 1);
+        }
+    }
+    usize elapsed = gettime() - start;
+    thread_join(tid);
+    // 每轮切换两次
+    printf("context switch: %d ns\n", (int)(elapsed / ROUNDS / 2));
+}
+
+/**
+ * 空系统调用的往返延迟
+ */
+void bench_syscall() {
+    int n = ROUNDS * 100;
+    usize start = gettime();
+    for (int i = 0; i < n; ++i) {
+        gettid();
+    }
+    usize elapsed = gettime() - start;
+    printf("null syscall: %d ns\n", (int)(elapsed / n));
+}
+
+/**
+ * 比较系统调用与 vDSO 读取时间和 pid 的开销
+ */
+void bench_vdso() {
+    int n = ROUNDS * 100;
+    struct timespec ts;
+    usize start = gettime();
+    for (int i = 0; i < n; ++i) {
+        gettime();
+    }
+    usize syscall_ns = (gettime() - start) / n;
+    start = gettime();
+    for (int i = 0; i < n; ++i) {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+    }
+    usize clock_ns = (gettime() - start) / n;
+    start = gettime();
+    for (int i = 0; i < n; ++i) {
+        getpid();
+    }
+    usize getpid_ns = (gettime() - start) / n;
+    printf("gettime syscall: %d ns, vdso clock_gettime: %d ns, "
+           "vdso getpid: %d ns\n",
+           (int)syscall_ns, (int)clock_ns, (int)getpid_ns);
+}
+
+#define BIG_WRITE (32 * 1024)
+char big[BIG_WRITE];
+
+/**
+ * 另一个进程不断执行长系统调用时，测量睡眠 1ms 后被唤醒的最大延迟
+ */
+void bench_latency() {
+    int pid = fork();
+    if (!pid) {
+        while (1) {
+            int fd = open("latency.tmp\0", O_CREATE);
+            write(fd, big, BIG_WRITE);
+            close(fd);
+        }
+    }
+    usize max = 0;
+    for (int i = 0; i < ROUNDS; ++i) {
+        usize start = gettime();
+        nanosleep(1000000);
+        usize late = gettime() - start - 1000000;
+        if (late > max) {
+            max = late;
+        }
+    }
+    kill(pid);
+    waitpid(pid);
+    printf("max sleep latency: %d us\n", (int)(max / 1000));
+}
+
+// 共享内存的第一页存放交接序号，其后为数据
+struct ShmHeader {
+    int seq;
+};
+
+/**
+ * 比较通过管道复制与通过共享内存交接 32KiB 缓冲区的开销
+ */
+void bench_shm() {
+    int fds[2];
+    pipe(fds);
+    int pid = fork();
+    if (!pid) {
+        close(fds[1]);
+        while (read(fds[0], big, BIG_WRITE) > 0) {
+        }
+        exit();
+    }
+    close(fds[0]);
+    usize start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        write(fds[1], big, BIG_WRITE);
+    }
+    close(fds[1]);
+    waitpid(pid);
+    usize pipe_ns = (gettime() - start) / ROUNDS;
+
+    if (shm_create("bench\0", PAGE_SIZE + BIG_WRITE) == -1) {
+        printf("shm create failed\n");
+        return;
+    }
+    struct ShmHeader *header = shm_attach("bench\0");
+    char *data = (char *)header + PAGE_SIZE;
+    // 子进程继承映射，生产者写奇数序号，消费者读完数据后写偶数序号
+    pid = fork();
+    if (!pid) {
+        for (int i = 0; i < ROUNDS; ++i) {
+            while (header->seq != 2 * i + 1) {
+                futex(&header->seq, FUTEX_WAIT, 2 * i);
+            }
+            big[0] = data[0];
+            header->seq = 2 * i + 2;
+            futex(&header->seq, FUTEX_WAKE, 1);
+        }
+        exit();
+    }
+    start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        while (header->seq != 2 * i) {
+            futex(&header->seq, FUTEX_WAIT, 2 * i - 1);
+        }
+        data[0] = i;
+        header->seq = 2 * i + 1;
+        futex(&header->seq, FUTEX_WAKE, 1);
+    }
+    waitpid(pid);
+    usize shm_ns = (gettime() - start) / ROUNDS;
+    shm_detach(header);
+    shm_unlink("bench\0");
+    printf("pipe 32KiB: %d ns, shm handoff: %d ns\n", (int)pipe_ns,
+           (int)shm_ns);
+}
+
+/**
+ * 比较同步 IPC 与一对管道的请求-应答往返延迟
+ */
+void bench_ipc() {
+    int n = ROUNDS * 10;
+    int req[2], resp[2];
+    pipe(req);
+    pipe(resp);
+    int pid = fork();
+    if (!pid) {
+        usize x;
+        while (read(req[0], (char *)&x, sizeof(x)) == sizeof(x)) {
+            ++x;
+            write(resp[1], (char *)&x, sizeof(x));
+        }
+        exit();
+    }
+    close(req[0]);
+    close(resp[1]);
+    usize x = 0;
+    usize start = gettime();
+    for (int i = 0; i < n; ++i) {
+        write(req[1], (char *)&x, sizeof(x));
+        read(resp[0], (char *)&x, sizeof(x));
+    }
+    usize pipe_ns = (gettime() - start) / n;
+    close(req[1]);
+    close(resp[0]);
+    waitpid(pid);
+
+    usize msg[IPC_MSG_WORDS] = {0};
+    pid = fork();
+    if (!pid) {
+        // 回复上一个调用者并等待下一条消息，被 kill 时返回 -1
+        int from = ipc_reply_wait(0, msg);
+        while (from != -1) {
+            ++msg[0];
+            from = ipc_reply_wait(from, msg);
+        }
+        exit();
+    }
+    start = gettime();
+    for (int i = 0; i < n; ++i) {
+        ipc_call(pid, msg);
+    }
+    usize ipc_ns = (gettime() - start) / n;
+    kill(pid);
+    waitpid(pid);
+    if (msg[0] != n) {
+        printf("ipc reply mismatch\n");
+    }
+    printf("pipe round trip: %d ns, ipc round trip: %d ns\n", (int)pipe_ns,
+           (int)ipc_ns);
+}
+
+#define POLL_PIPES 4
+
+/**
+ * 一个进程用 poll 同时等待控制台和多个管道，测量每个事件的处理开销
+ */
+void bench_poll() {
+    int n = ROUNDS * 10;
+    int fds[POLL_PIPES][2];
+    for (int i = 0; i < POLL_PIPES; ++i) {
+        pipe(fds[i]);
+    }
+    int pid = fork();
+    if (!pid) {
+        char c = 0;
+        for (int i = 0; i < n; ++i) {
+            write(fds[i % POLL_PIPES][1], &c, 1);
+        }
+        exit();
+    }
+    struct PollFd pfds[POLL_PIPES + 1];
+    pfds[0] = (struct PollFd){0, POLLIN, 0};
+    for (int i = 0; i < POLL_PIPES; ++i) {
+        close(fds[i][1]);
+        pfds[i + 1] = (struct PollFd){fds[i][0], POLLIN, 0};
+    }
+    int events = 0;
+    usize start = gettime();
+    while (events < n) {
+        if (poll(pfds, POLL_PIPES + 1, -1) <= 0) {
+            break;
+        }
+        char buf[64];
+        // 丢弃测试期间的控制台输入
+        if (pfds[0].revents & POLLIN) {
+            read(0, buf, sizeof(buf));
+        }
+        for (int i = 1; i <= POLL_PIPES; ++i) {
+            if (pfds[i].revents & POLLIN) {
+                events += read(pfds[i].fd, buf, sizeof(buf));
+            }
+        }
+    }
+    usize elapsed = gettime() - start;
+    waitpid(pid);
+    for (int i = 0; i < POLL_PIPES; ++i) {
+        close(fds[i][0]);
+    }
+    printf("poll %d pipes: %d ns per event\n", POLL_PIPES,
+           (int)(elapsed / n));
+}
+
+#define MANY_FDS 500
+
+/**
+ * 持有大量文件描述符时，测量 fork+exit 与 dup+close 的开销
+ */
+void bench_fd() {
+    usize start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        int pid = fork();
+        if (!pid) {
+            exit();
+        }
+        waitpid(pid);
+    }
+    usize few = (gettime() - start) / ROUNDS;
+
+    int fds[MANY_FDS];
+    for (int i = 0; i < MANY_FDS; ++i) {
+        fds[i] = dup(1);
+    }
+    start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        int pid = fork();
+        if (!pid) {
+            exit();
+        }
+        waitpid(pid);
+    }
+    usize many = (gettime() - start) / ROUNDS;
+    start = gettime();
+    for (int i = 0; i < ROUNDS; ++i) {
+        close(dup(1));
+    }
+    usize dup_ns = (gettime() - start) / ROUNDS;
+    for (int i = 0; i < MANY_FDS; ++i) {
+        close(fds[i]);
+    }
+    printf("fork+exit: %d ns, with %d fds: %d ns, dup+close: %d ns\n",
+           (int)few, MANY_FDS, (int)many, (int)dup_ns);
+}
+
+#define SMALL_WRITE 16
+#define RING_BATCH 32
+
+/**
+ * 比较逐个系统调用与通过队列批量提交小块写入的开销
+ */
+void bench_ring() {
+    int n = RING_BATCH * 32;
+    int fd = open("ring.tmp\0", O_CREATE);
+    usize start = gettime();
+    for (int i = 0; i < n; ++i) {
+        write(fd, big, SMALL_WRITE);
+    }
+    usize syscall_ns = (gettime() - start) / n;
+    close(fd);
+
+    if (ring_init(0) == -1) {
+        printf("ring setup failed\n");
+        return;
+    }
+    fd = open("ring.tmp\0", O_CREATE);
+    struct RingCqe cqe;
+    start = gettime();
+    for (int i = 0; i < n; i += RING_BATCH) {
+        for (int j = 0; j < RING_BATCH; ++j) {
+            ring_prep(SYS_write, fd, (usize)big, SMALL_WRITE, i + j);
+        }
+        ring_submit();
+        while (ring_peek_cqe(&cqe)) {
+        }
+    }
+    usize ring_ns = (gettime() - start) / n;
+    close(fd);
+    printf("write syscall: %d ns, ring batch %d: %d ns\n", (int)syscall_ns,
+           RING_BATCH, (int)ring_ns);
+}
+
+struct Bench {
+    char *name;
+    void (*func)();
+};
+
+struct Bench benches[] = {
+    {"syscall", bench_syscall},
+    {"vdso", bench_vdso},
+    {"spawn", bench_spawn},
+    {"pingpong", bench_pingpong},
+    {"latency", bench_latency},
+    {"ring", bench_ring},
+    {"shm", bench_shm},
+    {"ipc", bench_ipc},
+    {"poll", bench_poll},
+    {"fd", bench_fd},
+};
+
+#define NR_BENCH (sizeof(benches) / sizeof(struct Bench))
+
+int main(int argc, char **argv) {
+    for (int i = 0; i < NR_BENCH; ++i) {
+        int selected = argc <= 1;
+        for (int j = 1; j < argc; ++j) {
+            if (!strcmp(argv[j], benches[i].name)) {
+                selected = 1;
+            }
+        }
+        if (selected) {
+            printf("[%s] ", benches[i].name);
+            benches[i].func();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include "kernel/types.h"
+#include "ulib.h"
+
+char buf[512];
+
+/**
+ * 将文件内容复制到标准输出
+ */
+void copy(int fd) {
+    int n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        if (write(1, buf, n) != n) {
+            exit();
+        }
+    }
+}
+
+/**
+ * `cat` 复制标准输入，`cat <file>...` 依次复制各个文件
+ */
+int main(int argc, char **argv) {
+    if (argc <= 1) {
+        copy(0);
+        return 0;
+    }
+    for (int i = 1; i < argc; ++i) {
+        int fd = open(argv[i], 0);
+        if (fd == -1) {
+            printf("cat: %s: No such file\n", argv[i]);
+            continue;
+        }
+        copy(fd);
+        close(fd);
+    }
+    return 0;
+}
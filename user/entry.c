@@ -2,12 +2,15 @@
 #include "kernel/types.h"
 #include "ulib.h"
 
-__attribute__((weak)) int main() {
+__attribute__((weak)) int main(int argc, char **argv) {
     panic("No main linked!\n");
     return 0;
 }
 
-void _start() {
-    main();
+/**
+ * 用户程序入口，spawn 在 a0、a1 中传入 argc、argv
+ */
+void _start(int argc, char **argv) {
+    main(argc, argv);
     exit();
-}
\ No newline at end of file
+}
@@ -5,20 +5,15 @@ int main() {
     int pid;
 
     // 简单测试文件系统功能
-    pid = fork();
-    if (!pid) {
-        exec("filetest\0");
-    } else {
-        pid = wait();
+    pid = spawn("filetest\0", NULL, NULL);
+    if (pid != -1) {
+        waitpid(pid);
         printf("Child %d terminated!\n", pid);
     }
 
-    pid = fork();
-    if (!pid) {
-        exec("shell\0");
-    }
+    spawn("shell\0", NULL, NULL);
     while ((pid = wait()) != -1) {
         printf("Child %d terminated!\n", pid);
     }
     return 0;
-}
\ No newline at end of file
+}
@@ -5,7 +5,29 @@
 
 static char digits[] = "0123456789abcdef";
 
-static void printint(int xx, int base, int sign) {
+/**
+ * 输出缓冲区，一次 printf 的输出攒够一块再写入标准输出
+ */
+struct PrintBuf {
+    char buf[128];
+    int len;
+};
+
+static void flush(struct PrintBuf *pb) {
+    if (pb->len) {
+        write(1, pb->buf, pb->len);
+        pb->len = 0;
+    }
+}
+
+static void putc(struct PrintBuf *pb, char c) {
+    pb->buf[pb->len++] = c;
+    if (pb->len == sizeof(pb->buf)) {
+        flush(pb);
+    }
+}
+
+static void printint(struct PrintBuf *pb, int xx, int base, int sign) {
     char buf[16];
     int i;
     uint x;
@@ -24,27 +46,30 @@ static void printint(int xx, int base, int sign) {
         buf[i++] = '-';
 
     while (--i >= 0)
-        putchar(buf[i]);
+        putc(pb, buf[i]);
 }
 
-static void printptr(usize x) {
+static void printptr(struct PrintBuf *pb, usize x) {
     int i;
-    putchar('0');
-    putchar('x');
+    putc(pb, '0');
+    putc(pb, 'x');
     for (i = 0; i < (sizeof(usize) * 2); i++, x <<= 4)
-        putchar(digits[x >> (sizeof(usize) * 8 - 4)]);
+        putc(pb, digits[x >> (sizeof(usize) * 8 - 4)]);
 }
 
 void __printf(char *fmt, va_list ap) {
     int i;
     char c, *s;
+    struct PrintBuf out;
+    struct PrintBuf *pb = &out;
+    pb->len = 0;
 
     if (!fmt)
         panic("[printf] null fmt");
 
     for (i = 0; (c = fmt[i] & 0xff) != 0; i++) {
         if (c != '%') {
-            putchar(c);
+            putc(pb, c);
             continue;
         }
         c = fmt[++i] & 0xff;
@@ -52,29 +77,30 @@ void __printf(char *fmt, va_list ap) {
             break;
         switch (c) {
         case 'd':
-            printint(va_arg(ap, int), 10, 1);
+            printint(pb, va_arg(ap, int), 10, 1);
             break;
         case 'x':
-            printint(va_arg(ap, int), 16, 1);
+            printint(pb, va_arg(ap, int), 16, 1);
             break;
         case 'p':
-            printptr(va_arg(ap, usize));
+            printptr(pb, va_arg(ap, usize));
             break;
         case 's':
             if ((s = va_arg(ap, char *)) == 0)
                 s = "(null)";
             for (; *s; s++)
-                putchar(*s);
+                putc(pb, *s);
             break;
         case '%':
-            putchar('%');
+            putc(pb, '%');
             break;
         default:
-            putchar('%');
-            putchar(c);
+            putc(pb, '%');
+            putc(pb, c);
             break;
         }
     }
+    flush(pb);
 }
 
 void printf(char *fmt, ...) {
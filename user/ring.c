@@ -0,0 +1,69 @@
+#include "kernel/types.h"
+#include "kernel/ring.h"
+#include "ulib.h"
+
+/**
+ * 批量系统调用队列
+ *
+ * 先用 ring_prep 填写请求，再用 ring_submit 一次提交，
+ * 轮询模式下也可以不提交，等待内核定期处理
+ */
+
+static struct Ring *ring;
+
+/**
+ * 建立队列
+ *
+ * @param flags RING_POLL 表示轮询模式
+ * @return -1 表示失败
+ */
+int ring_init(int flags) {
+    usize addr = ring_setup(flags);
+    if (addr == -1) {
+        return -1;
+    }
+    ring = (struct Ring *)addr;
+    return 0;
+}
+
+/**
+ * 在提交队列中填写一个请求
+ *
+ * @return -1 表示提交队列已满
+ */
+int ring_prep(int op, usize a0, usize a1, usize a2, usize user_data) {
+    if (ring->sq_tail - ring->sq_head == RING_ENTRIES) {
+        return -1;
+    }
+    struct RingSqe *sqe = &ring->sq[ring->sq_tail & RING_MASK];
+    sqe->op = op;
+    sqe->args[0] = a0;
+    sqe->args[1] = a1;
+    sqe->args[2] = a2;
+    sqe->user_data = user_data;
+    // 请求填写完成后才能移动队尾
+    asm volatile("fence w, w" ::: "memory");
+    ++ring->sq_tail;
+    return 0;
+}
+
+/**
+ * 提交所有已填写的请求
+ *
+ * @return 内核处理的请求数
+ */
+int ring_submit() { return ring_enter(ring->sq_tail - ring->sq_head); }
+
+/**
+ * 取出一个完成项
+ *
+ * @return 0 表示完成队列为空
+ */
+int ring_peek_cqe(struct RingCqe *cqe) {
+    if (ring->cq_head == ring->cq_tail) {
+        return 0;
+    }
+    *cqe = ring->cq[ring->cq_head & RING_MASK];
+    ++ring->cq_head;
+    return 1;
+}
@@ -8,6 +8,7 @@
 
 char line[256];
 int len;
+char *argv[MAX_ARGS + 1];
 
 inline int is_empty() { return len == 0; }
 
@@ -18,28 +19,108 @@ inline void clear() {
     len = 0;
 }
 
+/**
+ * 按空格将命令行切分为参数
+ *
+ * @return 参数个数
+ */
+int parse() {
+    int argc = 0;
+    for (int i = 0; i < len; ++i) {
+        if (line[i] == ' ') {
+            line[i] = '\0';
+        } else if ((i == 0 || line[i - 1] == '\0') && argc < MAX_ARGS) {
+            argv[argc++] = &line[i];
+        }
+    }
+    argv[argc] = NULL;
+    return argc;
+}
+
+// 管道线中的命令数上限
+#define MAX_STAGES 8
+
+inline int is_pipe(char *arg) { return arg[0] == '|' && !arg[1]; }
+
+/**
+ * 执行以 `|` 连接的管道线，前一条命令的标准输出连接到后一条命令的标准输入
+ */
+void run(int argc) {
+    int pids[MAX_STAGES];
+    int nr = 0;
+    // 上一条命令输出的管道读端，-1 表示使用标准输入
+    int prev = -1;
+    char **cmd = argv;
+    for (int i = 0; i <= argc; ++i) {
+        if (i < argc && !is_pipe(argv[i])) {
+            continue;
+        }
+        int last = i == argc;
+        argv[i] = NULL;
+        int fds[2];
+        if (!last && nr == MAX_STAGES - 1) {
+            printf("pipe: too many stages\n");
+            break;
+        }
+        if (!last && pipe(fds) == -1) {
+            printf("pipe: cannot create pipe\n");
+            break;
+        }
+        // 连接标准输入输出后，关闭子进程中多余的管道端，保证读者能读到文件尾
+        struct SpawnAction actions[6];
+        int n = 0;
+        if (prev != -1) {
+            actions[n++] = (struct SpawnAction){0, prev};
+            actions[n++] = (struct SpawnAction){prev, -1};
+        }
+        if (!last) {
+            actions[n++] = (struct SpawnAction){1, fds[1]};
+            actions[n++] = (struct SpawnAction){fds[1], -1};
+            actions[n++] = (struct SpawnAction){fds[0], -1};
+        }
+        actions[n] = (struct SpawnAction){-1, -1};
+        if (cmd[0]) {
+            int pid = spawn(cmd[0], cmd, actions);
+            if (pid == -1) {
+                printf("%s: No such file\n", cmd[0]);
+            } else {
+                pids[nr++] = pid;
+            }
+        }
+        if (prev != -1) {
+            close(prev);
+            prev = -1;
+        }
+        if (last) {
+            break;
+        }
+        close(fds[1]);
+        prev = fds[0];
+        cmd = &argv[i + 1];
+    }
+    if (prev != -1) {
+        close(prev);
+    }
+    for (int i = 0; i < nr; ++i) {
+        waitpid(pids[i]);
+    }
+}
+
 int main() {
     clear();
     printf("$ ");
     while (1) {
-        int pid;
+        int argc;
         char c = getchar();
         switch (c) {
         case LF:
         case CR:
             printf("\n");
-            if (!is_empty()) {
-                pid = fork();
-                if (!pid) {
-                    if (exec(line) == -1) {
-                        printf("%s: No such file\n", line);
-                        exit();
-                    }
-                }
-                while (wait() == -1) {
-                }
-                clear();
+            argc = parse();
+            if (argc) {
+                run(argc);
             }
+            clear();
             printf("$ ");
             break;
         case BS:
@@ -1,5 +1,6 @@
 #include "kernel/syscall.h"
 #include "kernel/types.h"
+#include "kernel/sysstat.h"
 
 #define sys_call(__num, __a0, __a1, __a2)                                      \
     ({                                                                         \
@@ -16,16 +17,25 @@
 
 void exit() { sys_call(SYS_exit, 0, 0, 0); }
 
-void putchar(char c) { sys_call(SYS_putchar, c, 0, 0); }
-
-int getpid() { return sys_call(SYS_getpid, 0, 0, 0); }
+/**
+ * 输出到标准输出，标准输出可能被重定向到管道
+ */
+void putchar(char c) { sys_call(SYS_write, 1, &c, 1); }
 
 int fork() { return sys_call(SYS_fork, 0, 0, 0); }
 
 int wait() { return sys_call(SYS_wait, 0, 0, 0); }
 
+int waitpid(int pid) { return sys_call(SYS_waitpid, pid, 0, 0); }
+
+int kill(int pid) { return sys_call(SYS_kill, pid, 0, 0); }
+
 int exec(char *name) { return sys_call(SYS_exec, (usize)name, 0, 0); }
 
+int spawn(char *path, char **argv, struct SpawnAction *actions) {
+    return sys_call(SYS_spawn, (usize)path, (usize)argv, (usize)actions);
+}
+
 int open(char *name, int flags) {
     return sys_call(SYS_open, (usize)name, flags, 0);
 }
@@ -40,6 +50,96 @@ int write(int fd, char *buf, int count) {
     return sys_call(SYS_write, fd, (usize)buf, count);
 }
 
+int nanosleep(usize ns) { return sys_call(SYS_nanosleep, ns, 0, 0); }
+
+int sleep_until(usize ns) { return sys_call(SYS_sleep_until, ns, 0, 0); }
+
+usize gettime() { return sys_call(SYS_gettime, 0, 0, 0); }
+
+int clone(void *entry, void *arg0, void *arg1) {
+    return sys_call(SYS_clone, (usize)entry, (usize)arg0, (usize)arg1);
+}
+
+int join(int tid) { return sys_call(SYS_join, tid, 0, 0); }
+
+int gettid() { return sys_call(SYS_gettid, 0, 0, 0); }
+
+int futex(int *addr, int op, int val) {
+    return sys_call(SYS_futex, (usize)addr, op, val);
+}
+
+int times(struct ProcTimes *times) {
+    return sys_call(SYS_times, (usize)times, 0, 0);
+}
+
+int proc_list(struct ProcInfo *buf, int max) {
+    return sys_call(SYS_proc_list, (usize)buf, max, 0);
+}
+
+usize ring_setup(int flags) { return sys_call(SYS_ring_setup, flags, 0, 0); }
+
+int ring_enter(int to_submit) {
+    return sys_call(SYS_ring_enter, to_submit, 0, 0);
+}
+
+int pipe(int *fds) { return sys_call(SYS_pipe, fds, 0, 0); }
+
+int dup(int oldfd) { return sys_call(SYS_dup, oldfd, 0, 0); }
+
+int dup2(int oldfd, int newfd) { return sys_call(SYS_dup2, oldfd, newfd, 0); }
+
+int shm_create(char *name, usize size) {
+    return sys_call(SYS_shm_create, name, size, 0);
+}
+
+void *shm_attach(char *name) {
+    return (void *)sys_call(SYS_shm_attach, name, 0, 0);
+}
+
+int shm_detach(void *addr) { return sys_call(SYS_shm_detach, addr, 0, 0); }
+
+int shm_unlink(char *name) { return sys_call(SYS_shm_unlink, name, 0, 0); }
+
+int poll(struct PollFd *fds, int nfds, usize timeout) {
+    return sys_call(SYS_poll, fds, nfds, timeout);
+}
+
+int sysstat(int op, int pid, struct SyscallStats *stats) {
+    return sys_call(SYS_sysstat, op, pid, stats);
+}
+
+int trace_read(struct TraceRecord *buf, int max) {
+    return sys_call(SYS_trace_read, buf, max, 0);
+}
+
+/**
+ * 同步 IPC，msg 中的 IPC_MSG_WORDS 个字通过 a1~a4 传递，返回时被替换为
+ * 收到的消息
+ */
+static int ipc(int num, int pid, usize *msg) {
+    register unsigned long a0 asm("a0") = pid;
+    register unsigned long a1 asm("a1") = msg[0];
+    register unsigned long a2 asm("a2") = msg[1];
+    register unsigned long a3 asm("a3") = msg[2];
+    register unsigned long a4 asm("a4") = msg[3];
+    register unsigned long a7 asm("a7") = num;
+    asm volatile("ecall"
+                 : "+r"(a0), "+r"(a1), "+r"(a2), "+r"(a3), "+r"(a4)
+                 : "r"(a7)
+                 : "memory");
+    msg[0] = a1;
+    msg[1] = a2;
+    msg[2] = a3;
+    msg[3] = a4;
+    return a0;
+}
+
+int ipc_call(int pid, usize *msg) { return ipc(SYS_ipc_call, pid, msg); }
+
+int ipc_reply_wait(int reply_to, usize *msg) {
+    return ipc(SYS_ipc_reply_wait, reply_to, msg);
+}
+
 char getchar() {
     char c;
     read(0, &c, 1);
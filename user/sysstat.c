@@ -0,0 +1,130 @@
+#include "kernel/types.h"
+#include "kernel/sysstat.h"
+#include "ulib.h"
+
+/**
+ * 显示系统调用统计和跟踪记录
+ *
+ * `sysstat [pid]`         显示全系统或进程的统计
+ * `sysstat -e <pid>`      开始统计进程
+ * `sysstat -r [pid]`      清空全系统或进程的统计
+ * `sysstat -t <pid>`      开始跟踪进程，`-u <pid>` 停止跟踪
+ * `sysstat -l`            取出跟踪记录
+ * `sysstat -c <cmd> ...`  跟踪运行命令，结束后取出跟踪记录
+ */
+
+// 与 kernel/syscall.h 中的系统调用号一致
+char *syscall_name[] = {
+    "exit",       "putchar",    "getpid",     "fork",       "wait",
+    "exec",       "open",       "close",      "read",       "write",
+    "nanosleep",  "sleep_until", "gettime",   "clone",      "join",
+    "gettid",     "futex",      "waitpid",    "kill",       "spawn",
+    "times",      "proc_list",  "ring_setup", "ring_enter", "pipe",
+    "dup2",       "shm_create", "shm_attach", "shm_detach", "shm_unlink",
+    "ipc_call",   "ipc_reply_wait", "poll",   "sysstat",    "trace_read",
+    "dup",
+};
+
+#define NR_NAMES (sizeof(syscall_name) / sizeof(char *))
+#define TRACE_BATCH 16
+
+struct SyscallStats stats;
+struct TraceRecord records[TRACE_BATCH];
+
+char *name_of(int id) { return id < NR_NAMES ? syscall_name[id] : "?"; }
+
+int atoi(char *s) {
+    int x = 0;
+    for (; *s >= '0' && *s <= '9'; ++s) {
+        x = x * 10 + *s - '0';
+    }
+    return x;
+}
+
+void show_stats(int pid) {
+    if (sysstat(SYSSTAT_GET, pid, &stats) == -1) {
+        printf("sysstat: no stats for pid %d, try -e\n", pid);
+        return;
+    }
+    printf("SYSCALL\tCOUNT\tAVG(cyc)\tHISTOGRAM(log2 cyc:count)\n");
+    for (int i = 0; i < SYSSTAT_NR; ++i) {
+        struct SyscallStat *stat = &stats.calls[i];
+        if (!stat->count) {
+            continue;
+        }
+        printf("%s\t%d\t%d\t", name_of(i), (int)stat->count,
+               (int)(stat->cycles / stat->count));
+        for (int j = 0; j < SYSSTAT_BUCKETS; ++j) {
+            if (stat->hist[j]) {
+                printf("%d:%d ", j, (int)stat->hist[j]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+void show_trace() {
+    int n;
+    while ((n = trace_read(records, TRACE_BATCH)) > 0) {
+        for (int i = 0; i < n; ++i) {
+            struct TraceRecord *r = &records[i];
+            printf("[%d] %s(%x, %x, %x) = %d <%d cyc>\n", r->pid,
+                   name_of(r->id), (int)r->args[0], (int)r->args[1],
+                   (int)r->args[2], (int)r->ret, (int)r->cycles);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc <= 1) {
+        show_stats(0);
+        return 0;
+    }
+    if (argv[1][0] != '-') {
+        show_stats(atoi(argv[1]));
+        return 0;
+    }
+    int pid = argc > 2 ? atoi(argv[2]) : 0;
+    int ret = 0;
+    switch (argv[1][1]) {
+    case 'e':
+        ret = sysstat(SYSSTAT_ENABLE, pid, NULL);
+        break;
+    case 'r':
+        ret = sysstat(SYSSTAT_RESET, pid, NULL);
+        break;
+    case 't':
+        ret = sysstat(SYSSTAT_TRACE, pid, NULL);
+        break;
+    case 'u':
+        ret = sysstat(SYSSTAT_UNTRACE, pid, NULL);
+        break;
+    case 'l':
+        show_trace();
+        break;
+    case 'c':
+        if (argc <= 2) {
+            ret = -1;
+            break;
+        }
+        // 子进程继承跟踪标志，spawn 前跟踪自己，子进程从第一个系统调用起
+        // 就被跟踪，跟踪记录中也会有本进程的这次 spawn
+        sysstat(SYSSTAT_TRACE, getpid(), NULL);
+        pid = spawn(argv[2], &argv[2], NULL);
+        sysstat(SYSSTAT_UNTRACE, getpid(), NULL);
+        if (pid == -1) {
+            printf("%s: No such file\n", argv[2]);
+            return 0;
+        }
+        waitpid(pid);
+        show_trace();
+        break;
+    default:
+        ret = -1;
+        break;
+    }
+    if (ret == -1) {
+        printf("sysstat: failed\n");
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "kernel/types.h"
+#include "kernel/syscall.h"
+#include "ulib.h"
+
+/**
+ * 线程入口，线程函数返回后退出线程
+ */
+static void thread_start(void (*func)(void *), void *arg) {
+    func(arg);
+    exit();
+}
+
+/**
+ * 创建线程，与当前进程共享地址空间和打开文件表
+ *
+ * @return 线程的 tid，-1 表示创建失败
+ */
+int thread_create(void (*func)(void *), void *arg) {
+    return clone(thread_start, func, arg);
+}
+
+/**
+ * 等待线程退出
+ */
+int thread_join(int tid) { return join(tid); }
+
+/**
+ * 加锁，无竞争时只需一次原子操作，不进入内核
+ */
+void mutex_lock(struct Mutex *mutex) {
+    int c = 0;
+    if (__atomic_compare_exchange_n(&mutex->state, &c, 1, 0, __ATOMIC_ACQUIRE,
+                                    __ATOMIC_RELAXED)) {
+        return;
+    }
+    // 标记有等待者，然后睡眠直到锁被释放
+    if (c != 2) {
+        c = __atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE);
+    }
+    while (c != 0) {
+        futex(&mutex->state, FUTEX_WAIT, 2);
+        c = __atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE);
+    }
+}
+
+/**
+ * 尝试加锁
+ *
+ * @return 1 表示加锁成功
+ */
+int mutex_trylock(struct Mutex *mutex) {
+    int c = 0;
+    return __atomic_compare_exchange_n(&mutex->state, &c, 1, 0,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ * 解锁，只有可能有等待者时才进入内核唤醒
+ */
+void mutex_unlock(struct Mutex *mutex) {
+    if (__atomic_fetch_sub(&mutex->state, 1, __ATOMIC_RELEASE) != 1) {
+        __atomic_store_n(&mutex->state, 0, __ATOMIC_RELEASE);
+        futex(&mutex->state, FUTEX_WAKE, 1);
+    }
+}
+
+/**
+ * 释放锁并等待条件变量被通知，返回前重新加锁
+ */
+void cond_wait(struct Cond *cond, struct Mutex *mutex) {
+    int seq = __atomic_load_n(&cond->seq, __ATOMIC_ACQUIRE);
+    mutex_unlock(mutex);
+    // 序号在解锁后已经改变时不会睡眠
+    futex(&cond->seq, FUTEX_WAIT, seq);
+    mutex_lock(mutex);
+}
+
+void cond_signal(struct Cond *cond) {
+    __atomic_fetch_add(&cond->seq, 1, __ATOMIC_RELEASE);
+    futex(&cond->seq, FUTEX_WAKE, 1);
+}
+
+void cond_broadcast(struct Cond *cond) {
+    __atomic_fetch_add(&cond->seq, 1, __ATOMIC_RELEASE);
+    futex(&cond->seq, FUTEX_WAKE, 0x7fffffff);
+}
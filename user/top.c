@@ -0,0 +1,67 @@
+#include "kernel/types.h"
+#include "ulib.h"
+
+/**
+ * 显示各进程的 CPU 占用
+ *
+ * `top [n]` 每秒刷新一次，共刷新 n 次，默认 5 次
+ */
+
+#define MAX_PROCS 64
+#define NS_PER_SEC 1000000000UL
+
+struct ProcInfo prev[MAX_PROCS], cur[MAX_PROCS];
+int nr_prev;
+
+// 与内核中 enum ProcState 的顺序一致
+char *state_name[] = {"R", "R", "S", "Z"};
+
+/**
+ * 上一次采样中同一进程使用的 CPU 时间
+ *
+ * pid 可能已被新进程复用，因此同时比较 tgid
+ */
+usize prev_time(struct ProcInfo *info) {
+    for (int i = 0; i < nr_prev; ++i) {
+        if (prev[i].pid == info->pid && prev[i].tgid == info->tgid) {
+            return prev[i].times.utime + prev[i].times.stime;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int rounds = 0;
+    for (char *c = argc > 1 ? argv[1] : "5"; *c >= '0' && *c <= '9'; ++c) {
+        rounds = rounds * 10 + *c - '0';
+    }
+    nr_prev = proc_list(prev, MAX_PROCS);
+    usize last = gettime();
+    for (int r = 0; r < rounds; ++r) {
+        nanosleep(NS_PER_SEC);
+        int n = proc_list(cur, MAX_PROCS);
+        usize now = gettime();
+        usize elapsed = now - last;
+        printf("PID\tTGID\tS\tPRI\t%%CPU\tUSR(ms)\tSYS(ms)\tMCYCLE\tMINSTR\t"
+               "NAME\n");
+        for (int i = 0; i < n; ++i) {
+            struct ProcTimes *t = &cur[i].times;
+            usize total = t->utime + t->stime;
+            usize last_total = prev_time(&cur[i]);
+            // 复用 pid 的新进程用时可能少于上一次采样
+            usize used = total >= last_total ? total - last_total : total;
+            printf("%d\t%d\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t%s\n", cur[i].pid,
+                   cur[i].tgid, state_name[cur[i].state], cur[i].prio,
+                   (int)(used * 100 / elapsed), (int)(t->utime / 1000000),
+                   (int)(t->stime / 1000000), (int)(t->cycles / 1000000),
+                   (int)(t->instret / 1000000), cur[i].name);
+        }
+        printf("\n");
+        for (int i = 0; i < n; ++i) {
+            prev[i] = cur[i];
+        }
+        nr_prev = n;
+        last = now;
+    }
+    return 0;
+}
@@ -1,21 +1,95 @@
 #ifndef _ULIB_H
 #define _ULIB_H
 
+#include "kernel/types.h"
+#include "kernel/syscall.h"
+
 /* printf.c */
 void printf(char *, ...);
 void panic(char *, ...);
 
+/**
+ * 互斥锁，0 表示未加锁，1 表示已加锁，2 表示已加锁且可能有等待者
+ */
+struct Mutex {
+    int state;
+};
+
+/**
+ * 条件变量，每次通知时序号加一
+ */
+struct Cond {
+    int seq;
+};
+
+#define MUTEX_INITIALIZER {0}
+#define COND_INITIALIZER {0}
+
+/* thread.c */
+int thread_create(void (*)(void *), void *);
+int thread_join(int);
+void mutex_lock(struct Mutex *);
+int mutex_trylock(struct Mutex *);
+void mutex_unlock(struct Mutex *);
+void cond_wait(struct Cond *, struct Mutex *);
+void cond_signal(struct Cond *);
+void cond_broadcast(struct Cond *);
+
+struct timespec {
+    usize tv_sec;
+    usize tv_nsec;
+};
+
+/* vdso.c */
+int getpid();
+int clock_gettime(int, struct timespec *);
+
+struct RingCqe;
+struct SyscallStats;
+struct TraceRecord;
+
+/* ring.c */
+int ring_init(int);
+int ring_prep(int, usize, usize, usize, usize);
+int ring_submit();
+int ring_peek_cqe(struct RingCqe *);
+
 /* syscall.c */
 void putchar(char);
 void exit();
-int getpid();
 int fork();
 int wait();
+int waitpid(int);
+int kill(int);
 int exec(char *);
+int spawn(char *, char **, struct SpawnAction *);
 int open(char *, int);
 int close(int);
 int read(int, char *, int);
 int write(int, char *, int);
+int nanosleep(usize);
+int sleep_until(usize);
+usize gettime();
+int clone(void *, void *, void *);
+int join(int);
+int gettid();
+int futex(int *, int, int);
+int times(struct ProcTimes *);
+int proc_list(struct ProcInfo *, int);
+usize ring_setup(int);
+int ring_enter(int);
+int pipe(int *);
+int dup(int);
+int dup2(int, int);
+int shm_create(char *, usize);
+void *shm_attach(char *);
+int shm_detach(void *);
+int shm_unlink(char *);
+int poll(struct PollFd *, int, usize);
+int sysstat(int, int, struct SyscallStats *);
+int trace_read(struct TraceRecord *, int);
+int ipc_call(int, usize *);
+int ipc_reply_wait(int, usize *);
 char getchar();
 
 #endif
\ No newline at end of file
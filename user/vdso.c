@@ -0,0 +1,37 @@
+#include "kernel/types.h"
+#include "kernel/vdso.h"
+#include "ulib.h"
+
+/**
+ * 读取 vDSO 数据页，不陷入内核
+ */
+
+static inline usize rdtime() {
+    usize x;
+    asm volatile("rdtime %0" : "=r"(x));
+    return x;
+}
+
+int getpid() { return ((struct VdsoProc *)VDSO_PROC)->pid; }
+
+/**
+ * 获取系统启动以来的时间
+ *
+ * @param clock CLOCK_MONOTONIC 或 CLOCK_MONOTONIC_COARSE
+ * @return -1 表示不支持的时钟
+ */
+int clock_gettime(int clock, struct timespec *ts) {
+    struct VdsoData *data = (struct VdsoData *)VDSO_DATA;
+    usize ticks;
+    if (clock == CLOCK_MONOTONIC) {
+        ticks = rdtime();
+    } else if (clock == CLOCK_MONOTONIC_COARSE) {
+        ticks = data->ticks;
+    } else {
+        return -1;
+    }
+    ticks -= data->boot_time;
+    ts->tv_sec = ticks / data->timebase;
+    ts->tv_nsec = ticks % data->timebase * 1000000000 / data->timebase;
+    return 0;
+}